@@ -0,0 +1,220 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../Models/Position.h"
+
+using namespace std;
+
+// Пакетная оценка листьев дерева поиска.
+// Позиции хранятся структурой массивов битовых масок (бит i * 4 + j / 2 на тёмную клетку),
+// количество фигур и их потенциал считаются векторным popcount сразу для 8 позиций.
+// Результат совпадает с Logic::calc_score для режимов NumberOnly и NumberAndPotential.
+class Batch_eval
+{
+public:
+    static const int Capacity = 256; // максимальное количество позиций в пакете
+
+    // Сброс пакета и упаковка родительской позиции для последующих add(turn)
+    void clear(const Position& mtx)
+    {
+        n = 0;
+        pack(mtx, parent);
+    }
+
+    // Сброс пакета без родительской позиции (для инструментов анализа)
+    void clear()
+    {
+        n = 0;
+    }
+
+    int size() const
+    {
+        return n;
+    }
+
+    bool full() const
+    {
+        return n == Capacity;
+    }
+
+    // Добавление произвольной позиции
+    void add(const Position& mtx)
+    {
+        uint32_t m[4];
+        pack(mtx, m);
+        wm[n] = m[0], bm[n] = m[1], wk[n] = m[2], bk[n] = m[3];
+        ++n;
+    }
+
+    // Добавление позиции, получающейся из родительской тихим ходом turn
+    void add(const move_pos& turn)
+    {
+        const uint32_t from = bit(turn.x, turn.y), to = bit(turn.x2, turn.y2);
+        uint32_t m[4] = {parent[0], parent[1], parent[2], parent[3]};
+        for (int t = 0; t < 4; ++t)
+        {
+            if (!(m[t] & from))
+                continue;
+            m[t] ^= from;
+            // превращение в дамку на последней линии
+            if (t == 0 && turn.x2 == 0)
+                m[2] |= to;
+            else if (t == 1 && turn.x2 == 7)
+                m[3] |= to;
+            else
+                m[t] |= to;
+            break;
+        }
+        wm[n] = m[0], bm[n] = m[1], wk[n] = m[2], bk[n] = m[3];
+        ++n;
+    }
+
+    // Оценка всех позиций пакета, результат в score[0..size())
+    // first_bot_color - как в calc_score: true, если максимизирует игрок за черных
+    void evaluate(const bool potential, const bool first_bot_color)
+    {
+#if defined(__AVX2__)
+        count_avx2(potential);
+#else
+        count_scalar(potential);
+#endif
+        finish(potential, first_bot_color);
+    }
+
+    // То же без SIMD (эталон для сравнения и бенчмарка)
+    void evaluate_scalar(const bool potential, const bool first_bot_color)
+    {
+        count_scalar(potential);
+        finish(potential, first_bot_color);
+    }
+
+    double score[Capacity]; // оценки позиций пакета
+
+private:
+    static uint32_t bit(const POS_T i, const POS_T j)
+    {
+        return uint32_t(1) << (i * 4 + j / 2);
+    }
+
+    // Маски: белые шашки, черные шашки, белые дамки, черные дамки
+    static void pack(const Position& mtx, uint32_t* m)
+    {
+        m[0] = m[1] = m[2] = m[3] = 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = (i + 1) % 2; j < 8; j += 2)
+            {
+                if (mtx[i][j] == 1)
+                    m[0] |= bit(i, j);
+                else if (mtx[i][j] == 2)
+                    m[1] |= bit(i, j);
+                else if (mtx[i][j] == 3)
+                    m[2] |= bit(i, j);
+                else if (mtx[i][j] == 4)
+                    m[3] |= bit(i, j);
+            }
+        }
+    }
+
+    static int popcount(uint32_t x)
+    {
+        x = x - ((x >> 1) & 0x55555555);
+        x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+        return int((((x + (x >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+    }
+
+    void count_scalar(const bool potential)
+    {
+        for (int k = 0; k < n; ++k)
+        {
+            w_cnt[k] = popcount(wm[k]);
+            b_cnt[k] = popcount(bm[k]);
+            wq_cnt[k] = popcount(wk[k]);
+            bq_cnt[k] = popcount(bk[k]);
+            w_pot[k] = b_pot[k] = 0;
+            if (!potential)
+                continue;
+            // белые шашки ценятся по близости к строке 0, черные - к строке 7
+            for (int i = 0; i < 8; ++i)
+            {
+                w_pot[k] += (7 - i) * popcount((wm[k] >> (i * 4)) & 0xF);
+                b_pot[k] += i * popcount((bm[k] >> (i * 4)) & 0xF);
+            }
+        }
+    }
+
+#if defined(__AVX2__)
+    // popcount по полубайтам через таблицу в pshufb, взвешенная сумма строк через maddubs
+    void count_avx2(const bool potential)
+    {
+        const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low = _mm256_set1_epi8(0x0F);
+        const __m256i ones8 = _mm256_set1_epi8(1), ones16 = _mm256_set1_epi16(1);
+        // веса строк: младший полубайт байта k - строка 2k, старший - строка 2k + 1
+        const __m256i w_even = _mm256_set1_epi32(0x01030507), w_odd = _mm256_set1_epi32(0x00020406);
+        const __m256i b_even = _mm256_set1_epi32(0x06040200), b_odd = _mm256_set1_epi32(0x07050301);
+        for (int k = 0; k < n; k += 8)
+        {
+            __m256i cl[4], ch[4];
+            const uint32_t* src[4] = {wm + k, bm + k, wk + k, bk + k};
+            int* cnt[4] = {w_cnt + k, b_cnt + k, wq_cnt + k, bq_cnt + k};
+            for (int t = 0; t < 4; ++t)
+            {
+                const __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i*>(src[t]));
+                cl[t] = _mm256_shuffle_epi8(lut, _mm256_and_si256(m, low));
+                ch[t] = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi32(m, 4), low));
+                const __m256i c = _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_add_epi8(cl[t], ch[t]), ones8), ones16);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(cnt[t]), c);
+            }
+            __m256i wp = _mm256_setzero_si256(), bp = _mm256_setzero_si256();
+            if (potential)
+            {
+                wp = _mm256_add_epi16(_mm256_maddubs_epi16(cl[0], w_even), _mm256_maddubs_epi16(ch[0], w_odd));
+                bp = _mm256_add_epi16(_mm256_maddubs_epi16(cl[1], b_even), _mm256_maddubs_epi16(ch[1], b_odd));
+                wp = _mm256_madd_epi16(wp, ones16);
+                bp = _mm256_madd_epi16(bp, ones16);
+            }
+            _mm256_store_si256(reinterpret_cast<__m256i*>(w_pot + k), wp);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(b_pot + k), bp);
+        }
+    }
+#endif
+
+    // Перевод количества фигур в оценку по формуле calc_score
+    void finish(const bool potential, const bool first_bot_color)
+    {
+        const double q_coef = potential ? 5 : 4;
+        for (int k = 0; k < n; ++k)
+        {
+            double w = w_cnt[k] + 0.05 * w_pot[k], wq = wq_cnt[k];
+            double b = b_cnt[k] + 0.05 * b_pot[k], bq = bq_cnt[k];
+            int w_all = w_cnt[k] + wq_cnt[k], b_all = b_cnt[k] + bq_cnt[k];
+            if (!first_bot_color)
+            {
+                swap(b, w);
+                swap(bq, wq);
+                swap(b_all, w_all);
+            }
+            if (w_all == 0)
+                score[k] = 1e9; // INF из Logic.h
+            else if (b_all == 0)
+                score[k] = 0;
+            else
+                score[k] = (b + bq * q_coef) / (w + wq * q_coef);
+        }
+    }
+
+    int n = 0;
+    uint32_t parent[4] = {0, 0, 0, 0};
+
+    // структура массивов: маски позиций и промежуточные счётчики
+    alignas(32) uint32_t wm[Capacity] = {}, bm[Capacity] = {}, wk[Capacity] = {}, bk[Capacity] = {};
+    alignas(32) int w_cnt[Capacity] = {}, b_cnt[Capacity] = {}, wq_cnt[Capacity] = {}, bq_cnt[Capacity] = {};
+    alignas(32) int w_pot[Capacity] = {}, b_pot[Capacity] = {};
+};
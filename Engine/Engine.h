@@ -0,0 +1,377 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Logic.h"
+
+// Ограничения поиска: уровень бота (глубина), время и узлы (0 - без ограничения)
+struct Search_limits
+{
+    int depth = 64;
+    int64_t time_ms = 0;
+    int64_t nodes = 0;
+};
+
+// Результат поиска
+struct Search_result
+{
+    vector<move_pos> turn; // лучший ход (серия взятий - несколько элементов)
+    double score = 0;      // оценка с точки зрения ходящего в шкале calc_score
+    int depth = -1;        // последний полностью просчитанный уровень
+    int64_t nodes = 0;     // просмотрено узлов
+    int64_t time_ms = 0;   // затрачено времени
+    vector<vector<move_pos>> pv; // главная вариация: turn и продолжение из таблицы перестановок
+};
+
+// Движок без графики: позиция, правила и поиск.
+// Позиции задаются строкой PDN FEN ("W:W21,22,K30:B1,2"), клетки нумеруются 1..32
+// по тёмным полям сверху вниз (черные начинают на 1..12, белые на 21..32).
+// Ходы записываются номерами клеток: "22-18" для тихого хода, "22x15x8" для серии взятий.
+class Engine
+{
+public:
+    explicit Engine(const Bot_options& options = Bot_options()) : logic(options)
+    {
+        set_start_position();
+    }
+
+    // Начальная расстановка, ходят белые
+    void set_start_position()
+    {
+        set_position("W:W21-32:B1-12");
+    }
+
+    // Установка позиции из строки FEN, при ошибке позиция не меняется
+    bool set_position(const string& fen)
+    {
+        Position res;
+        stringstream ss(fen);
+        string part;
+        if (!getline(ss, part, ':') || (part != "W" && part != "B"))
+            return false;
+        const bool res_color = (part == "B");
+        while (getline(ss, part, ':'))
+        {
+            if (part.empty() || (part[0] != 'W' && part[0] != 'B'))
+                return false;
+            const bool white = (part[0] == 'W');
+            stringstream list(part.substr(1));
+            string item;
+            while (getline(list, item, ','))
+            {
+                if (!item.empty() && item.back() == '.')
+                    item.pop_back();
+                if (item.empty())
+                    continue;
+                const bool king = (item[0] == 'K');
+                if (king)
+                    item = item.substr(1);
+                int from = 0, to = 0;
+                const size_t dash = item.find('-');
+                if (!parse_square(item.substr(0, dash), from) ||
+                    !parse_square(dash == string::npos ? item : item.substr(dash + 1), to) || from > to)
+                    return false;
+                for (int sq = from; sq <= to; ++sq)
+                {
+                    const POS_T i = square_row(sq), j = square_col(sq);
+                    res[i][j] = POS_T((white ? 1 : 2) + (king ? 2 : 0));
+                }
+            }
+        }
+        mtx = res;
+        color = res_color;
+        history.assign(1, mtx);
+        history_color = color;
+        return true;
+    }
+
+    // Позиция партии: positions - позиции перед каждым ходом, в первой ходит first_color, текущая - последняя.
+    // Все позиции становятся историей для поиска повторений
+    void set_game(const vector<Position>& positions, const bool first_color)
+    {
+        mtx = positions.back();
+        color = first_color != ((positions.size() - 1) % 2 == 1);
+        history = positions;
+        history_color = first_color;
+    }
+
+    // Текущая позиция в формате FEN
+    string position() const
+    {
+        return to_fen(mtx, color);
+    }
+
+    // Позиция mtx с ходом цвета color в формате FEN
+    static string to_fen(const Position& mtx, const bool color)
+    {
+        string res = color ? "B" : "W";
+        for (int side = 1; side <= 2; ++side)
+        {
+            res += (side == 1 ? ":W" : ":B");
+            bool first = true;
+            for (int sq = 1; sq <= 32; ++sq)
+            {
+                const POS_T type = mtx[square_row(sq)][square_col(sq)];
+                if (!type || (type - 1) % 2 + 1 != side)
+                    continue;
+                if (!first)
+                    res += ",";
+                first = false;
+                res += (type > 2 ? "K" : "") + to_string(sq);
+            }
+        }
+        return res;
+    }
+
+    // Цвет ходящего (false - белые, true - черные)
+    bool side_to_move() const
+    {
+        return color;
+    }
+
+    // Доска в представлении Board (0 - пусто, 1..4 - фигуры)
+    const Position& board() const
+    {
+        return mtx;
+    }
+
+    // Все полные ходы ходящей стороны (серии взятий развёрнуты до конца)
+    vector<vector<move_pos>> legal_moves()
+    {
+        return legal_moves(mtx, color);
+    }
+
+    // Выполнение полного хода, если он допустим
+    bool play(const vector<move_pos>& turn)
+    {
+        for (auto& legal : legal_moves())
+        {
+            if (legal != turn)
+                continue;
+            apply(legal);
+            return true;
+        }
+        return false;
+    }
+
+    // Выполнение хода, записанного номерами клеток
+    bool play(const string& move)
+    {
+        for (auto& turn : legal_moves())
+        {
+            if (move_to_string(turn) != move)
+                continue;
+            apply(turn);
+            return true;
+        }
+        return false;
+    }
+
+    // Размер таблицы перестановок в байтах (0 - без таблицы), таблица очищается
+    void set_hash_size(const size_t bytes)
+    {
+        hash.resize(bytes);
+        logic.set_hash(&hash);
+    }
+
+    // Таблица перестановок в общей памяти name, общая для всех процессов с тем же именем и размером.
+    // false - общая память недоступна, остаётся прежняя таблица
+    bool set_shared_hash(const string& name, const size_t bytes)
+    {
+        if (!hash.attach_shared(name, bytes))
+            return false;
+        logic.set_hash(&hash);
+        return true;
+    }
+
+    size_t hash_size() const
+    {
+        return hash.size_bytes();
+    }
+
+    // Поиск с итеративным углублением: результат последнего полностью просчитанного уровня.
+    // on_depth вызывается после каждого уровня (для вывода информации о поиске)
+    Search_result search(const Search_limits& limits, const function<void(const Search_result&)>& on_depth = nullptr)
+    {
+        const auto start = chrono::steady_clock::now();
+        hash.new_search();
+        logic.set_history(history, history_color);
+        logic.set_limits(&stop_flag, limits.nodes,
+                         limits.time_ms ? start + chrono::milliseconds(limits.time_ms)
+                                        : chrono::steady_clock::time_point::max());
+        Search_result res;
+        // MCTS тратит весь бюджет за один вызов - итераций углубления нет
+        const int max_depth = logic.uses_mcts() ? 0 : limits.depth;
+        for (int depth = 0; depth <= max_depth; ++depth)
+        {
+            logic.Max_depth = depth;
+            auto turn = logic.find_best_turns(mtx, color);
+            if (logic.is_aborted() || turn.empty() || turn[0].x == -1)
+                break;
+            res.turn = turn;
+            res.pv = principal_variation(turn, depth);
+            res.score = logic.best_score;
+            res.depth = depth;
+            res.nodes = logic.nodes;
+            res.time_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+            if (on_depth)
+                on_depth(res);
+            // исход партии уже известен - углубляться дальше бессмысленно
+            if (is_win(res.score) || is_loss(res.score))
+                break;
+        }
+        logic.set_limits(nullptr, 0);
+        // лимит не дал закончить даже первый уровень - ходим первым допустимым ходом
+        if (res.turn.empty())
+        {
+            auto moves = legal_moves();
+            if (!moves.empty())
+                res.turn = moves[0];
+            res.pv.assign(1, res.turn);
+        }
+        res.time_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        return res;
+    }
+
+    // Остановка поиска из другого потока. Флаг держится до clear_stop(), поэтому остановка,
+    // пришедшая раньше, чем поток поиска дошёл до search(), не теряется
+    void stop()
+    {
+        stop_flag = true;
+    }
+
+    // Сброс остановки: вызывается в потоке, который запускает поиск, до его запуска
+    void clear_stop()
+    {
+        stop_flag = false;
+    }
+
+    // Запись хода номерами клеток
+    static string move_to_string(const vector<move_pos>& turn)
+    {
+        if (turn.empty())
+            return "";
+        string res = to_string(square_number(turn[0].x, turn[0].y));
+        for (auto step : turn)
+            res += (step.xb != -1 ? "x" : "-") + to_string(square_number(step.x2, step.y2));
+        return res;
+    }
+
+    // Номер клетки 1..32 по координатам доски и обратно
+    static int square_number(const POS_T i, const POS_T j)
+    {
+        return i * 4 + j / 2 + 1;
+    }
+
+    static POS_T square_row(const int sq)
+    {
+        return POS_T((sq - 1) / 4);
+    }
+
+    static POS_T square_col(const int sq)
+    {
+        return POS_T(2 * ((sq - 1) % 4) + (square_row(sq) % 2 == 0 ? 1 : 0));
+    }
+
+private:
+    static bool parse_square(const string& text, int& sq)
+    {
+        if (text.empty() || text.size() > 2 || !isdigit(text[0]) || !isdigit(text.back()))
+            return false;
+        sq = stoi(text);
+        return sq >= 1 && sq <= 32;
+    }
+
+    // Полные ходы цвета side в позиции pos
+    vector<vector<move_pos>> legal_moves(const Position& pos, const bool side)
+    {
+        vector<vector<move_pos>> res;
+        logic.find_turns(side, pos);
+        const auto first = logic.turns;
+        if (!logic.have_beats)
+        {
+            for (auto turn : first)
+                res.push_back({turn});
+            return res;
+        }
+        for (auto turn : first)
+            add_captures(logic.make_turn(pos, turn), {turn}, res);
+        return res;
+    }
+
+    // Главная вариация уровня depth: ход из корня, затем лучшие ходы из таблицы перестановок, пока запись
+    // есть, ход допустим и позиция не повторяется. Таблица хранит первый шаг серии взятий - берётся
+    // первая допустимая серия с этим шагом
+    vector<vector<move_pos>> principal_variation(const vector<move_pos>& turn, const int depth)
+    {
+        vector<vector<move_pos>> res = {turn};
+        auto cur = mtx;
+        bool side = color;
+        vector<uint64_t> seen = {Zobrist::hash(cur, side)};
+        for (int ply = 1;; ++ply)
+        {
+            for (auto step : res.back())
+                cur = logic.make_turn(cur, step);
+            side = !side;
+            const uint64_t key = Zobrist::hash(cur, side);
+            if (ply > depth || find(seen.begin(), seen.end(), key) != seen.end())
+                break;
+            seen.push_back(key);
+            // после хода бота ходит соперник - в таблице это позиции минимизирующего
+            const move_pos first = logic.hash_move(cur, side, ply % 2 == 0);
+            if (first.x == -1)
+                break;
+            bool found = false;
+            for (auto& next : legal_moves(cur, side))
+            {
+                if (next[0] == first)
+                {
+                    res.push_back(next);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                break;
+        }
+        return res;
+    }
+
+    void apply(const vector<move_pos>& turn)
+    {
+        for (auto step : turn)
+            mtx = logic.make_turn(mtx, step);
+        color = !color;
+        history.push_back(mtx);
+    }
+
+    // Продолжение серии взятий фигурой, закончившей ход path
+    void add_captures(const Position& cur, vector<move_pos> path, vector<vector<move_pos>>& res)
+    {
+        logic.find_turns(path.back().x2, path.back().y2, cur);
+        if (!logic.have_beats)
+        {
+            res.push_back(path);
+            return;
+        }
+        const auto next = logic.turns;
+        for (auto turn : next)
+        {
+            path.push_back(turn);
+            add_captures(logic.make_turn(cur, turn), path, res);
+            path.pop_back();
+        }
+    }
+
+    Logic logic;
+    Hash_table hash; // таблица перестановок поиска
+    Position mtx;              // текущая позиция
+    bool color = false;        // цвет ходящего
+    vector<Position> history;  // позиции с set_position до текущей (для поиска повторений)
+    bool history_color = false; // кто ходит в первой из них
+    atomic<bool> stop_flag{false};
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "Engine.h"
+
+using namespace std;
+
+// Настройки разбора партии
+struct Analysis_options
+{
+    Bot_options bot;       // оценка и перебор (кэш позиций, решатель и MCTS не используются)
+    int depth = 8;         // глубина поиска каждой позиции
+    int64_t time_ms = 0;   // предел времени на позицию (0 - без предела)
+    int threads = 0;       // потоков поиска (0 - все ядра)
+    size_t hash_mb = 16;   // таблица перестановок каждого потока
+    double blunder = 0.08; // ошибка - потеря ln(отношения сил) не меньше этой (шашка при 12 на 12 - 0.087)
+};
+
+// Разбор одного хода партии; оценки - с точки зрения сделавшего ход в шкале calc_score
+struct Move_annotation
+{
+    enum Kind : uint8_t
+    {
+        None,
+        Blunder,   // ход заметно хуже лучшего или ведёт к проигрышу
+        Missed_win // был форсированный выигрыш, а ход его упускает
+    };
+
+    Kind kind = None;
+    vector<move_pos> played; // сделанный ход
+    vector<move_pos> best;   // лучший ход по поиску
+    double played_score = 0;
+    double best_score = 0;
+};
+
+// Разбор партии после её окончания: позиции ищутся независимо на все ядра (у потока свой движок
+// и таблица перестановок, поиски разбираются из общей очереди), с историей партии до позиции для
+// поиска повторений. Оценка сделанного хода - поиск следующей позиции на глубину на 1 меньше,
+// обращённый к ходившему: горизонт тот же, что у лучшего хода в поиске позиции перед ходом,
+// поэтому оценки сравнимы и не качаются от чётности глубины
+class Game_analysis
+{
+public:
+    // positions - позиции перед каждым ходом и последняя позиция партии, в первой ходит first_color.
+    // done - счётчик законченных поисков из 2 * (positions.size() - 1) (для индикации), stop - прерывание.
+    // Возвращает разбор каждого хода: positions.size() - 1 записей, пусто при несвязанных позициях
+    static vector<Move_annotation> analyze(const vector<Position>& positions, const bool first_color,
+                                           const Analysis_options& opt, atomic<int>* done = nullptr,
+                                           const atomic<bool>* stop = nullptr)
+    {
+        const size_t count = positions.size();
+        if (count < 2)
+            return {};
+        // поиски 0..count-2 - позиции перед ходами на полную глубину, count-1..2*count-3 - позиции
+        // после ходов на глубину на 1 меньше
+        const size_t tasks = 2 * (count - 1);
+        vector<Search_result> found(tasks);
+        vector<vector<move_pos>> played(count - 1);
+        atomic<bool> bad{false};
+        atomic<size_t> next{0};
+        Bot_options options = opt.bot;
+        options.cache_path.clear();
+        options.solver_pieces = 0;
+        options.search = Search_method::AlphaBeta;
+        options.no_random = true;
+        const int threads =
+            max(1, min(int(tasks), opt.threads > 0 ? opt.threads : int(max(1u, thread::hardware_concurrency()))));
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]() {
+                Engine engine(options);
+                engine.set_hash_size(opt.hash_mb << 20);
+                Engine probe;
+                for (size_t task = next++; task < tasks && !bad && !(stop && *stop); task = next++)
+                {
+                    const bool reply = task >= count - 1;
+                    const size_t k = reply ? task - (count - 1) + 1 : task;
+                    if (!reply && !find_move(probe, positions[k], first_color != (k % 2 == 1), positions[k + 1],
+                                             played[k]))
+                        bad = true;
+                    const vector<Position> history(positions.begin(), positions.begin() + k + 1);
+                    engine.set_game(history, first_color);
+                    if (engine.legal_moves().empty())
+                        found[task].score = loss_score(0);
+                    else
+                    {
+                        Search_limits limits;
+                        limits.depth = max(1, opt.depth) - (reply ? 1 : 0);
+                        limits.time_ms = opt.time_ms;
+                        found[task] = engine.search(limits);
+                    }
+                    if (done)
+                        ++*done;
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+        if (bad || (stop && *stop))
+            return {};
+
+        vector<Move_annotation> res(count - 1);
+        for (size_t k = 0; k + 1 < count; ++k)
+        {
+            Move_annotation& a = res[k];
+            a.played = played[k];
+            a.best = found[k].turn;
+            a.best_score = found[k].score;
+            a.played_score = opponent_view(found[count - 1 + k].score);
+            if (a.played == a.best)
+                continue;
+            if (is_win(a.best_score) && !is_win(a.played_score))
+                a.kind = Move_annotation::Missed_win;
+            else if (!is_loss(a.best_score) && !is_win(a.played_score) &&
+                     (is_loss(a.played_score) || log(a.best_score) - log(a.played_score) >= opt.blunder))
+                a.kind = Move_annotation::Blunder;
+        }
+        return res;
+    }
+
+    // Оценка позиции для противника ходящего: обратное отношение сил, выигрыш через n полуходов -
+    // проигрыш через n + 1 и наоборот
+    static double opponent_view(const double score)
+    {
+        if (is_win(score))
+            return loss_score(plies_to_end(score) + 1);
+        if (is_loss(score))
+            return win_score(plies_to_end(score) + 1);
+        return 1 / score;
+    }
+
+private:
+    // Ход из from (ходит color) в to
+    static bool find_move(Engine& probe, const Position& from, const bool color,
+                          const Position& to, vector<move_pos>& res)
+    {
+        const string fen = Engine::to_fen(from, color);
+        probe.set_position(fen);
+        for (auto& turn : probe.legal_moves())
+        {
+            probe.set_position(fen);
+            probe.play(turn);
+            if (probe.board() == to)
+            {
+                res = turn;
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,755 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Engine.h"
+#include "Hash_table.h"
+#include "Shared_memory.h"
+
+using namespace std;
+
+// Партия: начальная позиция, ходы номерами клеток ("22-18", "22x15x6") и результат
+struct Game_record
+{
+    enum Result : int8_t
+    {
+        Black_win = -1,
+        Draw = 0,
+        White_win = 1,
+        Unknown = 2
+    };
+
+    string fen;           // начальная позиция ("" - начальная расстановка)
+    vector<string> moves; // ходы по порядку
+    int8_t result = Unknown;
+};
+
+// База партий с поиском по позиции. Два файла:
+//  - prefix.cgd - партии: заголовок, смещения партий и сами партии (результат, FEN, ходы строками);
+//  - prefix.cgi - индекс: записи (ключ Зобриста позиции, продолжение) с числом партий и итогами,
+//    отсортированные по ключу, и списки номеров партий для каждой записи.
+// Оба файла отображаются в память только для чтения, запрос позиции - двоичный поиск по записям,
+// поэтому он не зависит от числа партий и не читает их. Партии собираются из PDN (build разбирает
+// ходы параллельно в нескольких потоках, каждый поток сортирует свои позиции, затем они сливаются).
+// Файлы пишутся под временными именами и переименовываются, так что открытая база не портится.
+// Работает только на платформах с mmap
+class Game_db
+{
+public:
+    static const uint32_t Version = 1;
+
+    // Продолжение из позиции и итоги партий, в которых оно сыграно
+    struct Continuation
+    {
+        string move;        // "22-18", серия взятий - начало и конец ("22x6"); "" - партия закончилась здесь
+        uint32_t games = 0; // партий с этим продолжением
+        uint32_t white_wins = 0;
+        uint32_t black_wins = 0;
+        uint32_t draws = 0;
+    };
+
+    struct Position_stats
+    {
+        uint32_t games = 0; // сумма по продолжениям (партия, прошедшая позицию дважды разными ходами, - дважды)
+        uint32_t white_wins = 0;
+        uint32_t black_wins = 0;
+        uint32_t draws = 0;
+        vector<Continuation> moves; // по убыванию числа партий
+    };
+
+    struct Build_stats
+    {
+        size_t games = 0;     // партий в базе
+        size_t bad_games = 0; // партий с недопустимым ходом (в базе до этого хода)
+        size_t positions = 0; // позиций всех партий
+        size_t records = 0;   // записей индекса
+        int64_t ms = 0;
+    };
+
+    Game_db() = default;
+    Game_db(const Game_db&) = delete;
+    Game_db& operator=(const Game_db&) = delete;
+
+    ~Game_db()
+    {
+        close();
+    }
+
+    bool open(const string& prefix)
+    {
+        close();
+        if (!index_file.open(prefix + ".cgi") || !games_file.open(prefix + ".cgd"))
+        {
+            close();
+            return false;
+        }
+        const auto* ih = reinterpret_cast<const Index_header*>(index_file.base);
+        const auto* gh = reinterpret_cast<const Games_header*>(games_file.base);
+        if (index_file.length < sizeof(Index_header) || games_file.length < sizeof(Games_header) ||
+            memcmp(ih->magic, "CKGI", 4) != 0 || ih->version != Version || memcmp(gh->magic, "CKGD", 4) != 0 ||
+            gh->version != Version || ih->games != gh->games ||
+            index_file.length != sizeof(Index_header) + ih->records * sizeof(Record) + ih->postings * 4 ||
+            games_file.length < sizeof(Games_header) + (gh->games + 1) * 8)
+        {
+            close();
+            return false;
+        }
+        records = reinterpret_cast<const Record*>(index_file.base + sizeof(Index_header));
+        record_total = ih->records;
+        postings = reinterpret_cast<const uint32_t*>(records + record_total);
+        posting_total = ih->postings;
+        offsets = reinterpret_cast<const uint64_t*>(games_file.base + sizeof(Games_header));
+        game_total = gh->games;
+        game_data = reinterpret_cast<const char*>(offsets + game_total + 1);
+        if (size_t(game_data - games_file.base) + offsets[game_total] != games_file.length)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        index_file.close();
+        games_file.close();
+        records = nullptr;
+        postings = nullptr;
+        offsets = nullptr;
+        game_data = nullptr;
+        record_total = posting_total = game_total = 0;
+    }
+
+    bool is_open() const
+    {
+        return records != nullptr;
+    }
+
+    size_t game_count() const
+    {
+        return game_total;
+    }
+
+    size_t record_count() const
+    {
+        return record_total;
+    }
+
+    // Ключ k-й записи индекса (для выборок и замеров)
+    uint64_t key_at(const size_t k) const
+    {
+        return records[k].key;
+    }
+
+    // Статистика позиции mtx с ходом цвета color
+    Position_stats query(const Position& mtx, const bool color) const
+    {
+        return query(Zobrist::hash(mtx, color));
+    }
+
+    Position_stats query(const uint64_t key) const
+    {
+        Position_stats res;
+        const auto range = find(key);
+        for (const Record* r = range.first; r != range.second; ++r)
+        {
+            Continuation c;
+            if (r->from)
+                c.move = to_string(r->from) + (r->capture ? "x" : "-") + to_string(r->to);
+            c.games = r->games;
+            c.white_wins = r->white_wins;
+            c.black_wins = r->black_wins;
+            c.draws = r->draws;
+            res.games += c.games;
+            res.white_wins += c.white_wins;
+            res.black_wins += c.black_wins;
+            res.draws += c.draws;
+            res.moves.push_back(c);
+        }
+        stable_sort(res.moves.begin(), res.moves.end(),
+                    [](const Continuation& a, const Continuation& b) { return a.games > b.games; });
+        return res;
+    }
+
+    // Номера партий (не больше limit, по возрастанию), прошедших позицию
+    vector<uint32_t> games_with(const uint64_t key, const size_t limit) const
+    {
+        vector<uint32_t> res;
+        const auto range = find(key);
+        for (const Record* r = range.first; r != range.second; ++r)
+            res.insert(res.end(), postings + r->postings, postings + r->postings + r->games);
+        sort(res.begin(), res.end());
+        res.erase(unique(res.begin(), res.end()), res.end());
+        if (res.size() > limit)
+            res.resize(limit);
+        return res;
+    }
+
+    // Партия по номеру
+    Game_record game(const uint32_t id) const
+    {
+        Game_record res;
+        if (id >= game_total)
+            return res;
+        const char* p = game_data + offsets[id];
+        res.result = int8_t(*p++);
+        uint16_t len = 0;
+        memcpy(&len, p, 2);
+        p += 2;
+        res.fen.assign(p, len);
+        p += len;
+        uint16_t count = 0;
+        memcpy(&count, p, 2);
+        p += 2;
+        for (uint16_t k = 0; k < count; ++k)
+        {
+            const uint8_t n = uint8_t(*p++);
+            res.moves.emplace_back(p, n);
+            p += n;
+        }
+        return res;
+    }
+
+    // Сборка базы prefix из партий games в threads потоках (0 - все ядра).
+    // Партия с недопустимым ходом входит в базу до этого хода
+    static bool build(const string& prefix, const vector<Game_record>& games, int threads, Build_stats& stats,
+                      string& error)
+    {
+        const auto start = chrono::steady_clock::now();
+        stats = Build_stats();
+        stats.games = games.size();
+        if (games.size() > UINT32_MAX)
+        {
+            error = "too many games";
+            return false;
+        }
+        if (threads <= 0)
+            threads = max(1, int(thread::hardware_concurrency()));
+        threads = int(min<size_t>(threads, max<size_t>(1, games.size())));
+
+        // Позиции партий: каждый поток разбирает свою часть партий и сортирует найденное
+        vector<vector<Entry>> parts(threads);
+        atomic<size_t> bad{0};
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                Engine engine;
+                vector<Entry>& out = parts[t];
+                for (size_t g = t; g < games.size(); g += threads)
+                {
+                    const bool ok = replay(engine, games[g], [&](const Position& mtx, const bool color,
+                                                                 const vector<move_pos>* turn) {
+                        Entry e{Zobrist::hash(mtx, color), uint32_t(g), 0, 0, 0, 0};
+                        if (turn)
+                        {
+                            e.from = uint8_t(Engine::square_number(turn->front().x, turn->front().y));
+                            e.to = uint8_t(Engine::square_number(turn->back().x2, turn->back().y2));
+                            e.capture = turn->front().xb != -1;
+                        }
+                        out.push_back(e);
+                    });
+                    if (!ok)
+                        ++bad;
+                }
+                sort(out.begin(), out.end());
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+        stats.bad_games = bad;
+
+        // Слияние отсортированных частей в записи индекса; одна партия учитывается в записи один раз
+        vector<Record> index;
+        vector<uint32_t> lists;
+        using Head = pair<Entry, int>;
+        auto later = [](const Head& a, const Head& b) { return b.first < a.first; };
+        priority_queue<Head, vector<Head>, decltype(later)> heads(later);
+        vector<size_t> pos(threads, 0);
+        for (int t = 0; t < threads; ++t)
+        {
+            stats.positions += parts[t].size();
+            if (!parts[t].empty())
+                heads.push({parts[t][0], t});
+        }
+        while (!heads.empty())
+        {
+            const auto [e, t] = heads.top();
+            heads.pop();
+            if (++pos[t] < parts[t].size())
+                heads.push({parts[t][pos[t]], t});
+            else
+                vector<Entry>().swap(parts[t]);
+
+            if (index.empty() || !index.back().same(e))
+            {
+                if (lists.size() > UINT32_MAX)
+                {
+                    error = "too many positions";
+                    return false;
+                }
+                Record r = {};
+                r.key = e.key;
+                r.postings = uint32_t(lists.size());
+                r.from = e.from;
+                r.to = e.to;
+                r.capture = e.capture;
+                index.push_back(r);
+            }
+            else if (lists.back() == e.game)
+                continue;
+            Record& r = index.back();
+            lists.push_back(e.game);
+            ++r.games;
+            const int8_t result = games[e.game].result;
+            r.white_wins += result == Game_record::White_win;
+            r.black_wins += result == Game_record::Black_win;
+            r.draws += result == Game_record::Draw;
+        }
+        stats.records = index.size();
+
+        // Файлы пишутся рядом и заменяют старые целиком
+        Games_header gh = {};
+        memcpy(gh.magic, "CKGD", 4);
+        gh.version = Version;
+        gh.games = games.size();
+        ofstream gout(prefix + ".cgd.tmp", ios::binary | ios::trunc);
+        gout.write(reinterpret_cast<const char*>(&gh), sizeof(gh));
+        uint64_t offset = 0;
+        gout.write(reinterpret_cast<const char*>(&offset), 8);
+        for (auto& g : games)
+        {
+            offset += encoded_size(g);
+            gout.write(reinterpret_cast<const char*>(&offset), 8);
+        }
+        string buf;
+        for (auto& g : games)
+        {
+            encode(g, buf);
+            gout.write(buf.data(), streamsize(buf.size()));
+        }
+        gout.close();
+
+        Index_header ih = {};
+        memcpy(ih.magic, "CKGI", 4);
+        ih.version = Version;
+        ih.records = index.size();
+        ih.postings = lists.size();
+        ih.games = games.size();
+        ofstream iout(prefix + ".cgi.tmp", ios::binary | ios::trunc);
+        iout.write(reinterpret_cast<const char*>(&ih), sizeof(ih));
+        iout.write(reinterpret_cast<const char*>(index.data()), streamsize(index.size() * sizeof(Record)));
+        iout.write(reinterpret_cast<const char*>(lists.data()), streamsize(lists.size() * 4));
+        iout.close();
+
+        if (!gout || !iout || rename((prefix + ".cgd.tmp").c_str(), (prefix + ".cgd").c_str()) != 0 ||
+            rename((prefix + ".cgi.tmp").c_str(), (prefix + ".cgi").c_str()) != 0)
+        {
+            error = "can't write " + prefix + ".cgd/.cgi";
+            return false;
+        }
+        stats.ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    // Проход по партии: visit(позиция, цвет ходящего, ход) перед каждым ходом и visit(..., nullptr)
+    // в последней позиции. false - начальная позиция или ход недопустимы (проход обрывается перед ними)
+    template <class Visit> static bool replay(Engine& engine, const Game_record& game, Visit visit)
+    {
+        if (game.fen.empty())
+            engine.set_start_position();
+        else if (!engine.set_position(game.fen))
+            return false;
+        for (auto& text : game.moves)
+        {
+            const auto moves = engine.legal_moves();
+            const int k = match_move(moves, text);
+            if (k < 0)
+                return false;
+            visit(engine.board(), engine.side_to_move(), &moves[k]);
+            engine.play(moves[k]);
+        }
+        visit(engine.board(), engine.side_to_move(), nullptr);
+        return true;
+    }
+
+    // Номер хода text среди moves: полная запись серии или только начало и конец ("22x6"); -1 - нет такого
+    static int match_move(const vector<vector<move_pos>>& moves, const string& text)
+    {
+        vector<int> squares;
+        bool capture = false;
+        if (!parse_move(text, squares, capture))
+            return -1;
+        int found = -1;
+        for (size_t k = 0; k < moves.size(); ++k)
+        {
+            const auto& turn = moves[k];
+            if ((turn[0].xb != -1) != capture ||
+                Engine::square_number(turn[0].x, turn[0].y) != squares.front() ||
+                Engine::square_number(turn.back().x2, turn.back().y2) != squares.back())
+                continue;
+            if (squares.size() == turn.size() + 1)
+            {
+                bool same = true;
+                for (size_t s = 0; s + 1 < turn.size(); ++s)
+                    same = same && Engine::square_number(turn[s].x2, turn[s].y2) == squares[s + 1];
+                if (same)
+                    return int(k);
+            }
+            else if (squares.size() == 2 && found < 0)
+                found = int(k);
+        }
+        return found;
+    }
+
+    // Партия по позициям перед каждым ходом (как их хранит Game): ход между соседними позициями
+    // находится среди допустимых. false - соседние позиции не связаны одним ходом
+    static bool from_positions(const vector<Position>& positions, const bool first_color,
+                               const int8_t result, Game_record& res)
+    {
+        res = Game_record();
+        res.result = result;
+        if (positions.empty())
+            return false;
+        res.fen = Engine::to_fen(positions[0], first_color);
+        if (res.fen == Engine::to_fen(start_board(), false))
+            res.fen.clear();
+        Engine engine;
+        bool color = first_color;
+        for (size_t k = 0; k + 1 < positions.size(); ++k, color = !color)
+        {
+            const string fen = Engine::to_fen(positions[k], color);
+            engine.set_position(fen);
+            bool found = false;
+            for (auto& turn : engine.legal_moves())
+            {
+                engine.set_position(fen);
+                engine.play(turn);
+                if (engine.board() == positions[k + 1])
+                {
+                    res.moves.push_back(Engine::move_to_string(turn));
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                return false;
+        }
+        return true;
+    }
+
+    // Разбор PDN: теги Result и FEN, ходы номерами клеток или в алгебраической записи ("c3-d4", "c3:e5"),
+    // номера ходов, комментарии {...} и ;..., варианты (...) и NAG ($1) пропускаются.
+    // Партии добавляются в games, возвращается их число
+    static size_t read_pdn(const string& text, vector<Game_record>& games)
+    {
+        const size_t count = games.size();
+        Game_record cur;
+        bool started = false;
+        auto finish = [&]() {
+            if (started)
+                games.push_back(std::move(cur));
+            cur = Game_record();
+            started = false;
+        };
+        const size_t n = text.size();
+        size_t i = 0;
+        while (i < n)
+        {
+            const char c = text[i];
+            if (isspace(uint8_t(c)))
+            {
+                ++i;
+                continue;
+            }
+            if (c == '[')
+            {
+                // теги после ходов - следующая партия без результата в конце
+                if (!cur.moves.empty())
+                    finish();
+                size_t end = text.find(']', i);
+                end = end == string::npos ? n : end;
+                read_tag(text.substr(i + 1, end - i - 1), cur);
+                started = true;
+                i = min(n, end + 1);
+                continue;
+            }
+            if (c == '{' || c == ';')
+            {
+                const size_t end = text.find(c == '{' ? '}' : '\n', i);
+                i = end == string::npos ? n : end + 1;
+                continue;
+            }
+            if (c == '(')
+            {
+                for (int depth = 0; i < n; ++i)
+                {
+                    depth += (text[i] == '(') - (text[i] == ')');
+                    if (depth == 0)
+                        break;
+                }
+                ++i;
+                continue;
+            }
+            size_t end = i;
+            while (end < n && !isspace(uint8_t(text[end])) && !strchr("[{(;", text[end]))
+                ++end;
+            string token = text.substr(i, end - i);
+            i = end;
+            int8_t result = Game_record::Unknown;
+            if (parse_result(token, result))
+            {
+                cur.result = result;
+                started = true;
+                finish();
+                continue;
+            }
+            // номер хода ("12.", "12...", слитно с ходом "12.22-18")
+            size_t k = 0;
+            while (k < token.size() && isdigit(uint8_t(token[k])))
+                ++k;
+            if (k < token.size() && token[k] == '.')
+            {
+                while (k < token.size() && token[k] == '.')
+                    ++k;
+                token = token.substr(k);
+            }
+            while (!token.empty() && (token.back() == '!' || token.back() == '?'))
+                token.pop_back();
+            if (token.empty() || token[0] == '$' || token[0] == ')')
+                continue;
+            vector<int> squares;
+            bool capture = false;
+            if (parse_move(token, squares, capture))
+            {
+                token = to_string(squares[0]);
+                for (size_t s = 1; s < squares.size(); ++s)
+                    token += (capture ? "x" : "-") + to_string(squares[s]);
+            }
+            cur.moves.push_back(token);
+            started = true;
+        }
+        finish();
+        return games.size() - count;
+    }
+
+    // Партия в PDN (ходы номерами клеток, по 8 полных ходов в строке)
+    static string write_pdn(const Game_record& game)
+    {
+        string res = "[Event \"Checkers\"]\n";
+        if (!game.fen.empty())
+            res += "[FEN \"" + game.fen + "\"]\n";
+        res += "[Result \"" + result_string(game.result) + "\"]\n";
+        const bool black_first = !game.fen.empty() && game.fen[0] == 'B';
+        string line;
+        for (size_t k = 0; k < game.moves.size(); ++k)
+        {
+            const size_t ply = k + black_first;
+            if (ply % 2 == 0)
+                line += to_string(ply / 2 + 1) + ". ";
+            else if (k == 0)
+                line += "1... ";
+            line += game.moves[k] + " ";
+            if (ply % 16 == 15)
+            {
+                res += line + "\n";
+                line.clear();
+            }
+        }
+        return res + line + result_string(game.result) + "\n\n";
+    }
+
+    static string result_string(const int8_t result)
+    {
+        if (result == Game_record::White_win)
+            return "1-0";
+        if (result == Game_record::Black_win)
+            return "0-1";
+        if (result == Game_record::Draw)
+            return "1/2-1/2";
+        return "*";
+    }
+
+private:
+    struct Index_header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t records;
+        uint64_t postings;
+        uint64_t games;
+    };
+
+    struct Games_header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t games;
+    };
+
+    // Запись индекса: позиция и продолжение, партии с ним - postings[postings .. postings + games)
+    struct Record
+    {
+        uint64_t key;
+        uint32_t postings;
+        uint32_t games;
+        uint32_t white_wins;
+        uint32_t black_wins;
+        uint32_t draws;
+        uint8_t from, to; // продолжение номерами клеток (0 - партия закончилась в позиции)
+        uint8_t capture;
+        uint8_t reserved;
+
+        template <class T> bool same(const T& e) const
+        {
+            return key == e.key && from == e.from && to == e.to && capture == e.capture;
+        }
+    };
+    static_assert(sizeof(Record) == 32, "Record layout is part of the file format");
+
+    // Позиция партии при сборке
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t game;
+        uint8_t from, to, capture, reserved;
+
+        bool operator<(const Entry& b) const
+        {
+            if (key != b.key)
+                return key < b.key;
+            if (from != b.from)
+                return from < b.from;
+            if (to != b.to)
+                return to < b.to;
+            if (capture != b.capture)
+                return capture < b.capture;
+            return game < b.game;
+        }
+    };
+
+    pair<const Record*, const Record*> find(const uint64_t key) const
+    {
+        if (!is_open())
+            return {nullptr, nullptr};
+        const Record* first = lower_bound(records, records + record_total, key,
+                                          [](const Record& r, const uint64_t k) { return r.key < k; });
+        const Record* last = first;
+        while (last != records + record_total && last->key == key)
+            ++last;
+        return {first, last};
+    }
+
+    static const Position& start_board()
+    {
+        static const Position res = []() {
+            Engine engine;
+            return engine.board();
+        }();
+        return res;
+    }
+
+    static size_t encoded_size(const Game_record& g)
+    {
+        size_t res = 1 + 2 + min<size_t>(g.fen.size(), UINT16_MAX) + 2;
+        for (size_t k = 0; k < min<size_t>(g.moves.size(), UINT16_MAX); ++k)
+            res += 1 + min<size_t>(g.moves[k].size(), UINT8_MAX);
+        return res;
+    }
+
+    // Партия в файле: результат, длина и текст FEN, число ходов, ходы (длина и текст)
+    static void encode(const Game_record& g, string& out)
+    {
+        out.clear();
+        out.push_back(char(g.result));
+        const uint16_t len = uint16_t(min<size_t>(g.fen.size(), UINT16_MAX));
+        out.append(reinterpret_cast<const char*>(&len), 2);
+        out.append(g.fen, 0, len);
+        const uint16_t count = uint16_t(min<size_t>(g.moves.size(), UINT16_MAX));
+        out.append(reinterpret_cast<const char*>(&count), 2);
+        for (uint16_t k = 0; k < count; ++k)
+        {
+            const uint8_t n = uint8_t(min<size_t>(g.moves[k].size(), UINT8_MAX));
+            out.push_back(char(n));
+            out.append(g.moves[k], 0, n);
+        }
+    }
+
+    static bool parse_result(const string& token, int8_t& result)
+    {
+        if (token == "1-0" || token == "2-0")
+            result = Game_record::White_win;
+        else if (token == "0-1" || token == "0-2")
+            result = Game_record::Black_win;
+        else if (token == "1/2-1/2" || token == "1-1")
+            result = Game_record::Draw;
+        else if (token == "*")
+            result = Game_record::Unknown;
+        else
+            return false;
+        return true;
+    }
+
+    // Тег PDN: имя и значение в кавычках
+    static void read_tag(const string& tag, Game_record& game)
+    {
+        const size_t open = tag.find('"'), close = tag.rfind('"');
+        if (open == string::npos || close <= open)
+            return;
+        string name = tag.substr(0, open);
+        name.erase(remove_if(name.begin(), name.end(), [](char c) { return isspace(uint8_t(c)); }), name.end());
+        const string value = tag.substr(open + 1, close - open - 1);
+        if (name == "Result")
+            parse_result(value, game.result);
+        else if (name == "FEN")
+            game.fen = value;
+    }
+
+    // Клетки хода: номера 1..32 или поля "c3" (белые внизу, как в русской нотации)
+    static bool parse_move(const string& text, vector<int>& squares, bool& capture)
+    {
+        squares.clear();
+        capture = text.find_first_of("x:") != string::npos;
+        size_t k = 0;
+        while (k <= text.size())
+        {
+            size_t end = text.find_first_of("-x:", k);
+            end = end == string::npos ? text.size() : end;
+            const string part = text.substr(k, end - k);
+            int sq = 0;
+            if (part.size() == 2 && part[0] >= 'a' && part[0] <= 'h' && part[1] >= '1' && part[1] <= '8')
+            {
+                const int i = '8' - part[1], j = part[0] - 'a';
+                if ((i + j) % 2 == 0)
+                    return false;
+                sq = Engine::square_number(POS_T(i), POS_T(j));
+            }
+            else if (!part.empty() && part.size() <= 2 && all_of(part.begin(), part.end(), [](char c) { return isdigit(uint8_t(c)); }))
+                sq = stoi(part);
+            if (sq < 1 || sq > 32)
+                return false;
+            squares.push_back(sq);
+            k = end + 1;
+        }
+        return squares.size() >= 2;
+    }
+
+    Mapped_file index_file;
+    Mapped_file games_file;
+    const Record* records = nullptr;
+    const uint32_t* postings = nullptr;
+    const uint64_t* offsets = nullptr;
+    const char* game_data = nullptr;
+    size_t record_total = 0;
+    size_t posting_total = 0;
+    size_t game_total = 0;
+};
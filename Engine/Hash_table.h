@@ -0,0 +1,237 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "Shared_memory.h"
+
+using namespace std;
+
+// Ключи Зобриста. Генерируются из фиксированного зерна, поэтому одинаковы
+// во всех процессах и сборках (ключи можно хранить в файлах и общей памяти)
+class Zobrist
+{
+public:
+    // Ключ позиции mtx с ходом цвета color
+    static uint64_t hash(const Position& mtx, const bool color)
+    {
+        const Zobrist& z = get();
+        uint64_t res = color ? z.side : 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = (i + 1) % 2; j < 8; j += 2)
+            {
+                if (mtx[i][j])
+                    res ^= z.piece[mtx[i][j]][i * 4 + j / 2];
+            }
+        }
+        return res;
+    }
+
+    // Ключ после тихого хода фигуры type из (i, j) в (i2, j2) без превращения (ход дамки): key - ключ до хода
+    static uint64_t quiet_move(const uint64_t key, const POS_T type, const POS_T i, const POS_T j, const POS_T i2,
+                               const POS_T j2)
+    {
+        const Zobrist& z = get();
+        return key ^ z.side ^ z.piece[type][i * 4 + j / 2] ^ z.piece[type][i2 * 4 + j2 / 2];
+    }
+
+    // Дополнительный ключ для произвольного числа (настройки поиска, цвет бота)
+    static uint64_t salt(uint64_t value)
+    {
+        return splitmix(value);
+    }
+
+private:
+    Zobrist()
+    {
+        uint64_t state = 0x636865636b657273ULL; // "checkers"
+        for (int type = 1; type <= 4; ++type)
+            for (int sq = 0; sq < 32; ++sq)
+                piece[type][sq] = splitmix(state);
+        side = splitmix(state);
+    }
+
+    static const Zobrist& get()
+    {
+        static const Zobrist keys;
+        return keys;
+    }
+
+    static uint64_t splitmix(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t piece[5][32] = {};
+    uint64_t side = 0;
+};
+
+// Таблица перестановок: оценки и лучшие ходы уже просчитанных позиций.
+// Размер задаётся в байтах и округляется вниз до степени двойки записей, 0 - таблица выключена.
+// Таблица может лежать в общей памяти и использоваться несколькими процессами одновременно:
+// запись хранится тремя независимыми словами, а проверочное слово - ключ, сложенный по XOR
+// с двумя другими, поэтому запись, разорванная одновременной записью, просто не находится
+class Hash_table
+{
+public:
+    // Тип оценки: точная, нижняя или верхняя граница (результат отсечения)
+    enum Bound : uint8_t
+    {
+        None,
+        Exact,
+        Lower,
+        Upper
+    };
+
+    struct Entry
+    {
+        uint64_t key = 0;
+        double score = 0;
+        POS_T x = -1, y = -1, x2 = -1, y2 = -1; // лучший ход
+        uint8_t depth = 0;                      // оставшаяся глубина
+        Bound bound = None;
+        uint8_t generation = 0; // номер поиска, записавшего оценку
+
+        move_pos move() const
+        {
+            return move_pos(x, y, x2, y2);
+        }
+    };
+
+    Hash_table() = default;
+    Hash_table(const Hash_table&) = delete;
+    Hash_table& operator=(const Hash_table&) = delete;
+
+    void resize(const size_t bytes)
+    {
+        shared.reset();
+        count = slots_for(bytes);
+        own.reset(count ? new Slot[count]() : nullptr);
+        slots = own.get();
+        mask = count ? count - 1 : 0;
+    }
+
+    // Подключение к таблице в общей памяти name (её создаёт первый процесс),
+    // false - сегмент недоступен или другого размера, таблица не меняется
+    bool attach_shared(const string& name, const size_t bytes)
+    {
+        const size_t n = slots_for(bytes);
+        auto mem = make_unique<Shared_memory>();
+        if (!n || !mem->open(name, n * sizeof(Slot)))
+            return false;
+        own.reset();
+        shared = move(mem);
+        slots = reinterpret_cast<Slot*>(shared->data());
+        count = n;
+        mask = n - 1;
+        return true;
+    }
+
+    bool is_shared() const
+    {
+        return shared != nullptr;
+    }
+
+    size_t size_bytes() const
+    {
+        return count * sizeof(Slot);
+    }
+
+    bool enabled() const
+    {
+        return count != 0;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            slots[i].check.store(0, memory_order_relaxed);
+            slots[i].score.store(0, memory_order_relaxed);
+            slots[i].data.store(0, memory_order_relaxed);
+        }
+    }
+
+    // Новый поиск: записи прошлых поисков вытесняются в первую очередь
+    void new_search()
+    {
+        ++generation;
+    }
+
+    bool probe(const uint64_t key, Entry& entry) const
+    {
+        return read(slots[key & mask], entry) && entry.key == key;
+    }
+
+    // Замена: пустая запись, запись прошлого поиска, та же позиция или не большая глубина
+    void store(const uint64_t key, const int depth, const double score, const Bound bound, const move_pos& move)
+    {
+        Slot& slot = slots[key & mask];
+        Entry old;
+        if (read(slot, old) && old.key != key && old.generation == generation && old.depth > depth)
+            return;
+        uint64_t score_bits;
+        memcpy(&score_bits, &score, sizeof(score_bits));
+        const uint64_t data = uint64_t(uint8_t(move.x)) | uint64_t(uint8_t(move.y)) << 8 |
+                              uint64_t(uint8_t(move.x2)) << 16 | uint64_t(uint8_t(move.y2)) << 24 |
+                              uint64_t(uint8_t(depth)) << 32 | uint64_t(bound) << 40 | uint64_t(generation) << 48;
+        slot.check.store(key ^ score_bits ^ data, memory_order_relaxed);
+        slot.score.store(score_bits, memory_order_relaxed);
+        slot.data.store(data, memory_order_relaxed);
+    }
+
+private:
+    struct Slot
+    {
+        atomic<uint64_t> check{0}; // ключ ^ score ^ data
+        atomic<uint64_t> score{0};
+        atomic<uint64_t> data{0};
+    };
+    static_assert(sizeof(Slot) == 24, "Slot layout is shared between processes");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared table needs lock-free 64-bit atomics");
+
+    static size_t slots_for(const size_t bytes)
+    {
+        if (bytes < sizeof(Slot))
+            return 0;
+        size_t n = 1;
+        while (n * 2 * sizeof(Slot) <= bytes)
+            n *= 2;
+        return n;
+    }
+
+    static bool read(const Slot& slot, Entry& entry)
+    {
+        const uint64_t check = slot.check.load(memory_order_relaxed);
+        const uint64_t score_bits = slot.score.load(memory_order_relaxed);
+        const uint64_t data = slot.data.load(memory_order_relaxed);
+        entry.bound = Bound(uint8_t(data >> 40));
+        if (entry.bound == None)
+            return false;
+        entry.key = check ^ score_bits ^ data;
+        memcpy(&entry.score, &score_bits, sizeof(score_bits));
+        entry.x = POS_T(data);
+        entry.y = POS_T(data >> 8);
+        entry.x2 = POS_T(data >> 16);
+        entry.y2 = POS_T(data >> 24);
+        entry.depth = uint8_t(data >> 32);
+        entry.generation = uint8_t(data >> 48);
+        return true;
+    }
+
+    unique_ptr<Slot[]> own;             // таблица в памяти процесса
+    unique_ptr<Shared_memory> shared;   // или в общей памяти
+    Slot* slots = nullptr;
+    size_t count = 0;
+    size_t mask = 0;
+    uint8_t generation = 0;
+};
@@ -0,0 +1,1166 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "../Models/Project_path.h"
+#include "Batch_eval.h"
+#include "Hash_table.h"
+#include "Mcts.h"
+#include "NNUE.h"
+#include "Ntuple.h"
+#include "Position_cache.h"
+#include "Search_stats.h"
+#include "Solver.h"
+
+const int INF = 1e9;
+const double Draw_score = 1; // повторение позиции: силы равны
+
+// Исход партии в оценке учитывает расстояние: выигрыш на полуходе ply от корня - INF - ply,
+// проигрыш - ply * Loss_ply (меньше любого отношения сил). Бот выбирает самый быстрый выигрыш
+// и самое долгое сопротивление
+const int Max_plies = 1000;
+const double Loss_ply = 1e-9;
+
+inline double win_score(const int ply)
+{
+    return INF - ply;
+}
+
+inline double loss_score(const int ply)
+{
+    return ply * Loss_ply;
+}
+
+inline bool is_win(const double score)
+{
+    return score > INF - Max_plies;
+}
+
+inline bool is_loss(const double score)
+{
+    return score < Max_plies * Loss_ply;
+}
+
+// Полуходов до конца партии по оценке исхода
+inline int plies_to_end(const double score)
+{
+    return int(lround(is_win(score) ? INF - score : max(0.0, score) / Loss_ply));
+}
+
+// Оценка сети или n-кортежей (ln отношения сил) как отношение сил. Крайние значения ограничены:
+// e^13 ~ 4.4e5 и e^-13 ~ 2.3e-6 лежат вне полос выигрыша и проигрыша (is_win, is_loss)
+const double Max_eval_log = 13;
+
+inline double eval_ratio(const double v)
+{
+    return exp(min(Max_eval_log, max(-Max_eval_log, v)));
+}
+
+// Уровень оптимизации перебора (Bot/Optimization)
+enum class Optimization
+{
+    O0, // без отсечений
+    O1, // альфа-бета отсечение и отсечение при равенстве альфа и бета
+    O2  // только альфа-бета отсечение
+};
+
+// Способ оценки позиции (Bot/BotScoringType)
+enum class Scoring
+{
+    NumberOnly,
+    NumberAndPotential,
+    NNUE,
+    NTuple
+};
+
+// Метод поиска хода (Bot/BotEngine)
+enum class Search_method
+{
+    AlphaBeta, // перебор на глубину Max_depth
+    MCTS       // поиск Монте-Карло по дереву на все ядра
+};
+
+// Настройки бота: в игре заполняются из settings.json, в инструментах задаются напрямую
+struct Bot_options
+{
+    bool no_random = true;                               // детерминированный порядок ходов
+    Scoring scoring = Scoring::NumberAndPotential;      // Bot/BotScoringType
+    Optimization optimization = Optimization::O1;       // Bot/Optimization
+    string nnue_path;                                    // файл сети для Scoring::NNUE
+    string ntuple_path;                                  // файл весов для Scoring::NTuple
+    bool shared_memory = false;                          // данные только для чтения (сеть) - в общей памяти
+    string cache_path;                                   // файл постоянного кэша позиций (пусто - без кэша)
+    size_t cache_mb = 64;                                // размер файла кэша
+    int solver_pieces = 0;                               // решатель включается при стольких шашках и меньше (0 - выключен)
+    int64_t solver_ms = 1000;                            // время решателя на ход
+    size_t solver_mb = 64;                               // таблица решателя
+    Search_method search = Search_method::AlphaBeta;     // Bot/BotEngine
+    int64_t mcts_ms = 1000;                              // время MCTS на ход, если поиск не ограничен извне
+    int mcts_threads = 0;                                // потоков MCTS (0 - все ядра)
+    size_t mcts_mb = 64;                                 // пул узлов дерева MCTS
+    bool batch_leaves = true;                            // пакетная оценка листьев (false - поштучно, для сверки)
+
+    // Разбор строковых значений из settings.json
+    static Scoring parse_scoring(const string& name)
+    {
+        if (name == "NumberAndPotential")
+            return Scoring::NumberAndPotential;
+        if (name == "NNUE")
+            return Scoring::NNUE;
+        if (name == "NTuple")
+            return Scoring::NTuple;
+        return Scoring::NumberOnly;
+    }
+
+    static Search_method parse_search(const string& name)
+    {
+        return name == "MCTS" ? Search_method::MCTS : Search_method::AlphaBeta;
+    }
+
+    static Optimization parse_optimization(const string& name)
+    {
+        if (name == "O0")
+            return Optimization::O0;
+        if (name == "O2")
+            return Optimization::O2;
+        return Optimization::O1;
+    }
+};
+
+class Logic
+{
+public:
+    Logic(const Bot_options& options = Bot_options())
+    {
+        configure(options, true);
+    }
+
+    // Новые настройки между партиями. Заново загружаются только ресурсы, настройки которых изменились:
+    // веса оценки, кэш позиций, таблица решателя, пул узлов и потоки MCTS; остальные настройки - простые
+    // значения. Загруженные ресурсы с прежними настройками остаются тёплыми
+    void configure(const Bot_options& next, const bool reload_all = false)
+    {
+        const bool eval_changed =
+            reload_all || next.scoring != options.scoring ||
+            (next.scoring == Scoring::NNUE &&
+             (next.nnue_path != options.nnue_path || next.shared_memory != options.shared_memory)) ||
+            (next.scoring == Scoring::NTuple && next.ntuple_path != options.ntuple_path);
+        const bool cache_changed =
+            reload_all || next.cache_path != options.cache_path || next.cache_mb != options.cache_mb;
+        const bool solver_changed = reload_all || (next.solver_pieces > 0) != (options.solver_pieces > 0) ||
+                                    next.solver_mb != options.solver_mb;
+        const bool mcts_changed = reload_all || next.search != options.search ||
+                                  next.mcts_threads != options.mcts_threads || next.mcts_mb != options.mcts_mb;
+        const bool seed_changed = reload_all || next.no_random != options.no_random;
+        options = next;
+        optimization = next.optimization;
+        solver_pieces = next.solver_pieces;
+        solver_ms = next.solver_ms;
+        mcts_ms = next.mcts_ms;
+        batch_enabled = next.batch_leaves;
+        if (seed_changed)
+            rand_eng = std::default_random_engine(!options.no_random ? unsigned(time(0)) : 0);
+        if (eval_changed)
+            load_eval();
+        if (cache_changed)
+        {
+            flush_cache();
+            cache = nullptr;
+            if (!options.cache_path.empty())
+            {
+                cache = make_shared<Position_cache>();
+                if (!cache->open(options.cache_path, options.cache_mb << 20))
+                {
+                    ofstream fout(project_path + "log.txt", ios_base::app);
+                    fout << "Error: can't open position cache " << options.cache_path << "\n";
+                    fout.close();
+                    cache = nullptr;
+                }
+            }
+        }
+        if (solver_changed)
+            solver = solver_pieces > 0 ? make_shared<Proof_solver<Logic_rules>>(options.solver_mb << 20) : nullptr;
+        if (mcts_changed)
+            mcts = options.search == Search_method::MCTS
+                       ? make_shared<Mcts<Logic_rules>>(options.mcts_mb << 20, options.mcts_threads)
+                       : nullptr;
+        hash_salt = settings_salt();
+    }
+
+    // Начало новой партии: сбрасывается только состояние прошлой партии. Без случайности
+    // генератор начинает заново, чтобы партии с одинаковыми ходами игрока повторялись
+    void new_game()
+    {
+        if (options.no_random)
+            rand_eng = std::default_random_engine(0);
+        game_path.clear();
+        solved_key = 0;
+        solver_turn.clear();
+        solver_status = Solve_status::Unknown;
+        solver_length = 0;
+        cache_hit_depth = -1;
+        best_score = 0;
+        nodes = 0;
+    }
+
+    // Поиск лучшего хода (серии взятий) для цвета color в позиции mtx
+    vector<move_pos> find_best_turns(const Position& mtx, const bool color)
+    {
+        // Ходы в корне: перебор начинается с них
+        find_turns(color, mtx);
+
+        cache_hit_depth = -1;
+
+        // в эндшпиле решатель ищет форсированный выигрыш до конца партии; нерешённая позиция
+        // не решается повторно на следующих итерациях углубления Engine::search
+        const uint64_t solver_key = solver ? Zobrist::hash(mtx, color) ^ Zobrist::salt(uint64_t(plies_left)) : 0;
+        if (solver && solver_key != solved_key && count_pieces(mtx) <= solver_pieces)
+        {
+            int64_t budget = solver_ms;
+            if (stop_time != chrono::steady_clock::time_point::max())
+                budget = max<int64_t>(1, min<int64_t>(budget, chrono::duration_cast<chrono::milliseconds>(
+                                                                  stop_time - chrono::steady_clock::now())
+                                                                  .count()));
+            const auto solved = solver->solve(to_variant(mtx, color), plies_left, 0, budget);
+            solved_key = solver_key;
+            solver_status = solved.status;
+            solver_length = solved.length;
+            solver_turn.clear();
+            if (solved.status == Solve_status::Win && !solved.line.empty())
+            {
+                const Variant_move& m = solved.line[0];
+                vector<uint8_t> path(1, m.from);
+                path.insert(path.end(), m.path, m.path + m.length);
+                if (!restore_turn(mtx, color, path, solver_turn))
+                    solver_turn.clear();
+            }
+        }
+        else if (solver_key != solved_key)
+        {
+            solver_status = Solve_status::Unknown;
+            solver_length = 0;
+            solver_turn.clear();
+        }
+        if (!solver_turn.empty())
+        {
+            best_score = win_score(solver_length);
+            return solver_turn;
+        }
+
+        if (mcts)
+        {
+            // тот же бюджет, что у перебора в Engine::search (время, узлы, флаг остановки), иначе mcts_ms
+            int64_t budget = max_nodes ? 0 : mcts_ms;
+            if (stop_time != chrono::steady_clock::time_point::max())
+                budget = max<int64_t>(
+                    1, chrono::duration_cast<chrono::milliseconds>(stop_time - chrono::steady_clock::now()).count());
+            const auto found = mcts->search(to_variant(mtx, color), budget, max_nodes, plies_left, stop_flag);
+            nodes += found.playouts;
+            const double p = min(0.999, max(0.001, found.win_rate));
+            best_score = p / (1 - p);
+            vector<uint8_t> path(1, found.move.from);
+            path.insert(path.end(), found.move.path, found.move.path + found.move.length);
+            vector<move_pos> turn;
+            if (found.found && restore_turn(mtx, color, path, turn))
+                return turn;
+        }
+
+        // Позиция уже просчитана перебором не мельче в прошлых партиях - ход берётся из кэша.
+        // Кэш заменяет только перебор: решатель и MCTS отработали выше. Если в корень пришли тихим ходом
+        // дамки, перебор может встретить повторение позиции партии - оценка зависит от истории, кэш не нужен
+        const uint64_t root_key = Zobrist::hash(mtx, color);
+        const bool repeatable = !game_path.empty() && game_path.back().key == root_key && game_path.back().reversible;
+        const bool use_cache = cache && !repeatable;
+        const uint64_t cache_key = use_cache ? root_key ^ settings_salt() : 0;
+        if (use_cache)
+        {
+            vector<uint8_t> path;
+            vector<move_pos> cached;
+            int depth = 0;
+            double score = 0;
+            if (cache->find(cache_key, Max_depth, depth, score, path) && restore_turn(mtx, color, path, cached))
+            {
+                best_score = score;
+                cache_hit_depth = depth;
+                return cached;
+            }
+        }
+
+        if (scoring_mode == Scoring::NNUE)
+            nnue.refresh(mtx);
+        // путь перебора начинается с партии, если она передана для этой позиции
+        path = game_path;
+        if (path.empty() || path.back().key != root_key)
+            path.assign(1, {root_key, false});
+        if (stats)
+        {
+            stats_base = nodes;
+            stats->begin(Max_depth);
+        }
+        if (color)
+            start_search<true>(mtx);
+        else
+            start_search<false>(mtx);
+        if (stats)
+        {
+            stats->set_nodes(nodes - stats_base);
+            stats->end();
+        }
+
+        // Лучший ход - полная серия взятий или один ход
+        vector<move_pos> res = best_turn;
+
+        if (use_cache && !aborted && !res.empty())
+        {
+            vector<uint8_t> path = {uint8_t(res[0].x * 4 + res[0].y / 2)};
+            for (auto turn : res)
+                path.push_back(uint8_t(turn.x2 * 4 + turn.y2 / 2));
+            cache->store(cache_key, Max_depth, best_score, path);
+        }
+        return res;
+    }
+
+    // Сброс кэша позиций на диск
+    void flush_cache()
+    {
+        if (cache)
+            cache->flush();
+    }
+
+    // Ограничения поиска, проверяемые в каждом узле (используются Engine::search)
+    // stop - внешний флаг остановки, node_limit - 0 без ограничения
+    void set_limits(const atomic<bool>* stop, const int64_t node_limit,
+                    const chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max())
+    {
+        stop_flag = stop;
+        max_nodes = node_limit;
+        stop_time = deadline;
+        nodes = 0;
+        aborted = false;
+    }
+
+    // Ход поиска для отображения (nullptr - не публикуется), принадлежит вызывающему
+    void set_stats(Search_stats* s)
+    {
+        stats = s;
+    }
+
+    // Таблица перестановок для следующих поисков (nullptr - без таблицы), принадлежит вызывающему
+    void set_hash(Hash_table* table)
+    {
+        hash = (table && table->enabled()) ? table : nullptr;
+        // оценки зависят от способа оценки и отсечений - у разных настроек разные ключи
+        hash_salt = settings_salt();
+    }
+
+    // Позиции партии для поиска повторений: positions[k] - позиция перед k-м полуходом, первым ходит
+    // first_color, последняя - текущая позиция поиска. Повторение позиции на пути перебора или в партии
+    // оценивается как ничья, и перебор за ним не продолжается
+    void set_history(const vector<Position>& positions, const bool first_color)
+    {
+        game_path.clear();
+        for (size_t k = 0; k < positions.size(); ++k)
+        {
+            const bool color = first_color ^ (k % 2);
+            const bool reversible = k > 0 && is_reversible(positions[k - 1], positions[k]);
+            game_path.push_back({Zobrist::hash(positions[k], color), reversible});
+        }
+    }
+
+    // Ход ищется MCTS: глубина не используется
+    bool uses_mcts() const
+    {
+        return mcts != nullptr;
+    }
+
+    // Был ли последний поиск прерван ограничениями
+    bool is_aborted() const
+    {
+        return aborted;
+    }
+
+    // делаем ход
+    Position make_turn(Position mtx, move_pos turn) const
+    {
+        if (turn.xb != -1)
+            mtx[turn.xb][turn.yb] = 0;
+        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
+            mtx[turn.x][turn.y] += 2;
+        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
+        mtx[turn.x][turn.y] = 0;
+        return mtx;
+    }
+
+private:
+    // Позиция на пути перебора: ключ с цветом ходящего и признак того, что в неё пришли тихим ходом дамки
+    struct Path_entry
+    {
+        uint64_t key;
+        bool reversible;
+    };
+
+    // Позиция на пути перебора на время обработки узла
+    struct Path_guard
+    {
+        vector<Path_entry>& path;
+
+        Path_guard(vector<Path_entry>& path, const Path_entry& entry) : path(path)
+        {
+            path.push_back(entry);
+        }
+
+        ~Path_guard()
+        {
+            path.pop_back();
+        }
+    };
+
+    // Позиция key, в которую пришли тихим ходом дамки, уже была на пути. Смотреть дальше первой позиции,
+    // в которую пришли необратимым ходом (ход шашкой, взятие), бессмысленно: до неё фигур было иначе
+    bool is_repetition(const uint64_t key) const
+    {
+        for (size_t k = path.size(); k-- > 0;)
+        {
+            if (path[k].key == key)
+                return true;
+            if (!path[k].reversible)
+                break;
+        }
+        return false;
+    }
+
+    // Из before в after можно вернуться: шашки на месте и ничего не побито (сходила дамка)
+    static bool is_reversible(const Position& before, const Position& after)
+    {
+        int count_before = 0, count_after = 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if ((before[i][j] && before[i][j] < 3) || (after[i][j] && after[i][j] < 3))
+                {
+                    if (before[i][j] != after[i][j])
+                        return false;
+                }
+                count_before += before[i][j] != 0;
+                count_after += after[i][j] != 0;
+            }
+        }
+        return count_before == count_after;
+    }
+
+    // Серия взятий как один ход: шаги серии и позиция после неё
+    struct Capture_series
+    {
+        vector<move_pos> steps;
+        Position mtx;
+    };
+
+    // Полные серии взятий из позиции mtx по первым взятиям в turns (have_beats == true).
+    // Серии с одинаковой итоговой позицией (дамка бьёт те же шашки в другом порядке) остаются один раз
+    vector<Capture_series> find_series(const Position& mtx)
+    {
+        vector<Capture_series> res;
+        vector<move_pos> steps;
+        const auto first = turns;
+        for (auto turn : first)
+            extend_series(make_turn(mtx, turn), turn, steps, res);
+        return res;
+    }
+
+    // Продолжение серии после взятия turn (mtx - позиция после него)
+    void extend_series(const Position& mtx, const move_pos& turn, vector<move_pos>& steps,
+                       vector<Capture_series>& res)
+    {
+        steps.push_back(turn);
+        find_turns(turn.x2, turn.y2, mtx);
+        if (have_beats)
+        {
+            const auto next = turns;
+            for (auto t : next)
+                extend_series(make_turn(mtx, t), t, steps, res);
+        }
+        else if (none_of(res.begin(), res.end(), [&](const Capture_series& s) { return s.mtx == mtx; }))
+        {
+            res.push_back({steps, mtx});
+        }
+        steps.pop_back();
+    }
+
+    // Шаги серии в сети по одному (у каждого шага своя позиция до него)
+    void push_series(Position mtx, const vector<move_pos>& steps)
+    {
+        for (auto turn : steps)
+        {
+            nnue.push(mtx, turn);
+            mtx = make_turn(mtx, turn);
+        }
+    }
+
+    void pop_series(const vector<move_pos>& steps)
+    {
+        for (size_t k = 0; k < steps.size(); ++k)
+            nnue.pop();
+    }
+
+    static int count_pieces(const Position& mtx)
+    {
+        int res = 0;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                res += mtx[i][j] != 0;
+        return res;
+    }
+
+    // Позиция для решателя: клетка i * 4 + j / 2, как в кэше позиций
+    static Variant_position to_variant(const Position& mtx, const bool color)
+    {
+        Variant_position pos;
+        pos.color = color;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (!mtx[i][j])
+                    continue;
+                const uint64_t bit = 1ULL << (i * 4 + j / 2);
+                (mtx[i][j] % 2 ? pos.white : pos.black) |= bit;
+                if (mtx[i][j] > 2)
+                    pos.kings |= bit;
+            }
+        }
+        return pos;
+    }
+
+    // оценки зависят от способа оценки, её весов, отсечений и метода поиска - у разных настроек разные ключи
+    uint64_t settings_salt() const
+    {
+        // хеш содержимого весов: после переобучения или смены файла старые записи не находятся
+        const uint64_t weights = scoring_mode == Scoring::NNUE     ? nnue.weights_hash()
+                                 : scoring_mode == Scoring::NTuple ? ntuple.weights_hash()
+                                                                   : 0;
+        // у перебора с обычной оценкой ключи прежние, чтобы файлы кэша прошлых версий оставались верными
+        return Zobrist::salt(uint64_t(scoring_mode) * 4 + uint64_t(optimization) + (mcts ? 64 : 0)) ^ weights;
+    }
+
+    // Ход из кэша по клеткам path (i * 4 + j / 2): проверка, что это допустимая полная серия
+    bool restore_turn(const Position& mtx, const bool color, const vector<uint8_t>& path,
+                      vector<move_pos>& res)
+    {
+        auto cur = mtx;
+        POS_T x = POS_T(path[0] / 4), y = POS_T(path[0] % 4 * 2 + (path[0] / 4 + 1) % 2);
+        bool ok = true;
+        for (size_t k = 1; k < path.size() && ok; ++k)
+        {
+            const POS_T x2 = POS_T(path[k] / 4), y2 = POS_T(path[k] % 4 * 2 + (path[k] / 4 + 1) % 2);
+            if (k == 1)
+                find_turns(color, cur);
+            else
+                find_turns(x, y, cur);
+            auto it = find(turns.begin(), turns.end(), move_pos(x, y, x2, y2));
+            ok = it != turns.end() && (k == 1 || have_beats);
+            if (ok)
+            {
+                res.push_back(*it);
+                cur = make_turn(cur, *it);
+                x = x2;
+                y = y2;
+            }
+        }
+        // серия взятий должна быть доведена до конца
+        if (ok && res.back().xb != -1)
+        {
+            find_turns(x, y, cur);
+            ok = !have_beats;
+        }
+        find_turns(color, mtx);
+        return ok;
+    }
+
+    // Выбор специализации перебора по уровню оптимизации и способу оценки (один раз в корне)
+    template <bool Color> void start_search(const Position& mtx)
+    {
+        switch (optimization)
+        {
+        case Optimization::O0:
+            return start_search<Color, Optimization::O0>(mtx);
+        case Optimization::O1:
+            return start_search<Color, Optimization::O1>(mtx);
+        case Optimization::O2:
+            return start_search<Color, Optimization::O2>(mtx);
+        }
+    }
+
+    template <bool Color, Optimization Opt> void start_search(const Position& mtx)
+    {
+        switch (scoring_mode)
+        {
+        case Scoring::NumberOnly:
+            best_score = find_first_best_turn<Color, Opt, Scoring::NumberOnly>(mtx);
+            break;
+        case Scoring::NumberAndPotential:
+            best_score = find_first_best_turn<Color, Opt, Scoring::NumberAndPotential>(mtx);
+            break;
+        case Scoring::NNUE:
+            best_score = find_first_best_turn<Color, Opt, Scoring::NNUE>(mtx);
+            break;
+        case Scoring::NTuple:
+            best_score = find_first_best_turn<Color, Opt, Scoring::NTuple>(mtx);
+            break;
+        }
+    }
+
+    // Загрузка весов оценки по options.scoring; без файла бот продолжает играть с обычной оценкой
+    void load_eval()
+    {
+        scoring_mode = options.scoring;
+        nnue = NNUE();
+        ntuple = Ntuple();
+        if (scoring_mode == Scoring::NNUE && !nnue.load(options.nnue_path, options.shared_memory))
+        {
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Error: can't load NNUE network from " << options.nnue_path << ", using NumberAndPotential\n";
+            fout.close();
+            scoring_mode = Scoring::NumberAndPotential;
+        }
+        if (scoring_mode == Scoring::NTuple && !ntuple.load(options.ntuple_path))
+        {
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Error: can't load n-tuple weights from " << options.ntuple_path << ", using NumberAndPotential\n";
+            fout.close();
+            scoring_mode = Scoring::NumberAndPotential;
+        }
+    }
+
+    // Проверка внешней остановки, лимита узлов и времени (время - раз в 1024 узла)
+    bool should_stop()
+    {
+        if (!aborted && (stop_flag->load(memory_order_relaxed) || (max_nodes && nodes >= max_nodes) ||
+                         ((nodes & 1023) == 0 && chrono::steady_clock::now() >= stop_time)))
+            aborted = true;
+        return aborted;
+    }
+
+    // подсчет состояния бота
+    template <Scoring Mode> double calc_score(const Position& mtx, const bool first_bot_color) const
+    {
+        // color - who is max player
+        if constexpr (Mode == Scoring::NNUE)
+            return calc_nnue_score(first_bot_color);
+        if constexpr (Mode == Scoring::NTuple)
+            return calc_ntuple_score(mtx, first_bot_color);
+        double w = 0, wq = 0, b = 0, bq = 0;
+        int w_pot = 0, b_pot = 0; // суммарное продвижение шашек (целое, как в Batch_eval)
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                w += (mtx[i][j] == 1);  // количество белых фишек
+                wq += (mtx[i][j] == 3); //            белых королев
+                b += (mtx[i][j] == 2);  //            черных фишек
+                bq += (mtx[i][j] == 4); //            черных королев
+                w_pot += (mtx[i][j] == 1) * (7 - i);
+                b_pot += (mtx[i][j] == 2) * (i);
+            }
+        }
+        if constexpr (Mode == Scoring::NumberAndPotential) // подсчет очков для обычных фишек
+        {
+            w += 0.05 * w_pot;
+            b += 0.05 * b_pot;
+        }
+        if (!first_bot_color)
+        {
+            swap(b, w);
+            swap(bq, wq);
+        }
+        if (w + wq == 0)
+            return INF;
+        if (b + bq == 0)
+            return 0;
+        const int q_coef = (Mode == Scoring::NumberAndPotential ? 5 : 4);
+        return (b + bq * q_coef) / (w + wq * q_coef); // оценка состояния бота
+    }
+
+    // оценка нейросетью в той же шкале отношения сил, что и calc_score
+    double calc_nnue_score(const bool first_bot_color) const
+    {
+        if (nnue.pieces(!first_bot_color) == 0)
+            return INF;
+        if (nnue.pieces(first_bot_color) == 0)
+            return 0;
+        const double v = nnue.evaluate(); // ln(отношения сил) с точки зрения белых
+        return eval_ratio(first_bot_color ? -v : v);
+    }
+
+    // оценка n-кортежами в той же шкале
+    double calc_ntuple_score(const Position& mtx, const bool first_bot_color) const
+    {
+        uint8_t s[Ntuple::Squares];
+        int pieces[2];
+        Ntuple::states(mtx, s, pieces);
+        if (pieces[!first_bot_color] == 0)
+            return INF;
+        if (pieces[first_bot_color] == 0)
+            return 0;
+        const double v = ntuple.evaluate(s);
+        return eval_ratio(first_bot_color ? -v : v);
+    }
+
+
+    // Выигрыш (INF) или проигрыш (0) в оценке листа становится исходом на полуходе ply
+    static double at_ply(const double score, const int ply)
+    {
+        return score >= INF ? win_score(ply) : (score <= 0 ? loss_score(ply) : score);
+    }
+
+    // В таблице перестановок исход хранится от позиции узла, а не от корня: та же позиция
+    // встречается на другом полуходе и в поиске из следующих ходов партии
+    static double to_hash(const double score, const int ply)
+    {
+        if (is_win(score) && score <= INF)
+            return score + ply;
+        if (is_loss(score) && score >= 0)
+            return score - loss_score(ply);
+        return score;
+    }
+
+    static double from_hash(const double score, const int ply)
+    {
+        if (is_win(score) && score <= INF)
+            return score - ply;
+        if (is_loss(score) && score >= 0)
+            return score + loss_score(ply);
+        return score;
+    }
+
+    // Перебор в корне: ходы бота, взятия - полными сериями; лучший ход запоминается в best_turn.
+    // Color - цвет бота, Opt и Mode - настройки перебора, зафиксированные при компиляции
+    template <bool Color, Optimization Opt, Scoring Mode> double find_first_best_turn(const Position& mtx)
+    {
+        // ходы в корне уже найдены в find_best_turns
+        const bool now_have_beats = have_beats;
+        vector<Capture_series> now_turns;
+        if (now_have_beats)
+            now_turns = find_series(mtx);
+        else
+            for (auto turn : turns)
+                now_turns.push_back({{turn}, make_turn(mtx, turn)});
+
+        best_turn.clear();
+        double best_score = -1;  // Лучшая оценка хода
+
+        // Перебор всех возможных ходов, после каждого ход передаётся противнику
+        for (auto& turn : now_turns)
+        {
+            if constexpr (Mode == Scoring::NNUE)
+                push_series(mtx, turn.steps);
+            const bool reversible = !now_have_beats && mtx[turn.steps[0].x][turn.steps[0].y] > 2;
+            double score = find_best_turns_rec<!Color, false, Opt, Mode>(turn.mtx, 0, best_score, INF + 1, reversible);
+            if constexpr (Mode == Scoring::NNUE)
+                pop_series(turn.steps);
+
+            // Обновляем информацию о лучшем ходе
+            if (score > best_score)
+            {
+                best_score = score;
+                best_turn = turn.steps;
+                if (stats)
+                    stats->set_best(best_turn, best_score);
+            }
+        }
+
+        return best_score;
+    }
+
+    // Рекурсивная функция поиска лучшего хода с альфа-бета отсечением
+    // Color - цвет ходящего, Is_max - ходит ли максимизирующий игрок (нечетная глубина),
+    // reversible - в позицию пришли тихим ходом дамки (только такая позиция может оказаться повторением)
+    template <bool Color, bool Is_max, Optimization Opt, Scoring Mode>
+    double find_best_turns_rec(const Position& mtx, const size_t depth, double alpha = -1,
+        double beta = INF + 1, const bool reversible = false)
+    {
+        ++nodes;
+        if (stats && (nodes & 4095) == 0)
+            stats->set_nodes(nodes - stats_base);
+        // Поиск прерван - результат будет отброшен
+        if (stop_flag && should_stop())
+        {
+            return 0;
+        }
+
+        // Повторение позиции - ничья, цикл дальше не перебирается
+        const bool leaf = depth == size_t(Max_depth);
+        const uint64_t pos_key = (reversible || !leaf) ? Zobrist::hash(mtx, Color) : 0;
+        if (reversible && is_repetition(pos_key))
+        {
+            return Draw_score;
+        }
+
+        // Если достигнута максимальная глубина - оцениваем позицию
+        const int ply = int(depth) + 1; // полуход от корня
+        if (leaf)
+        {
+            return at_ply(calc_score<Mode>(mtx, Is_max == Color), ply);
+        }
+        Path_guard on_path(path, {pos_key, reversible});
+
+        // Отсечение по расстоянию до конца партии: в этом поддереве нет выигрыша раньше полухода ply
+        // и проигрыша раньше него же, поэтому уже найденный более быстрый исход не улучшить
+        if constexpr (Opt != Optimization::O0)
+        {
+            if (alpha >= win_score(ply))
+                return win_score(ply);
+            if (beta <= loss_score(ply))
+                return loss_score(ply);
+        }
+
+        // Позиции ищутся в таблице перестановок (кроме предпоследнего уровня)
+        const bool use_hash = hash && Max_depth - depth >= 2;
+        const int remaining = int(Max_depth - depth);
+        const double alpha_start = alpha, beta_start = beta;
+        uint64_t key = 0;
+        move_pos hash_move(-1, -1, -1, -1);
+        if (use_hash)
+        {
+            // оценки хранятся с точки зрения бота, поэтому ключ учитывает, кто максимизирует
+            key = pos_key ^ hash_salt ^ (Is_max ? Zobrist::salt(1) : 0);
+            Hash_table::Entry entry;
+            if (hash->probe(key, entry))
+            {
+                // оценку берём только с той же глубины: уровень бота задаёт глубину просчёта
+                const double stored = from_hash(entry.score, ply);
+                if (entry.depth == remaining &&
+                    (entry.bound == Hash_table::Exact || (entry.bound == Hash_table::Lower && stored >= beta) ||
+                     (entry.bound == Hash_table::Upper && stored <= alpha)))
+                    return stored;
+                hash_move = entry.move();
+            }
+        }
+
+        // Ищем все возможные ходы для текущего цвета, взятия - сразу полными сериями
+        find_turns<Color>(mtx);
+
+        auto curTurns = turns;
+        auto cur_have_beats = have_beats;
+        vector<Capture_series> cur_series;
+        if (cur_have_beats)
+            cur_series = find_series(mtx);
+        const size_t count = cur_have_beats ? cur_series.size() : curTurns.size();
+
+        // Лучший ход из таблицы (первый шаг серии) перебираем первым
+        if (hash_move.x != -1)
+        {
+            if (cur_have_beats)
+            {
+                auto it = find_if(cur_series.begin(), cur_series.end(),
+                                  [&](const Capture_series& s) { return s.steps[0] == hash_move; });
+                if (it != cur_series.end())
+                    swap(*it, cur_series[0]);
+            }
+            else
+            {
+                auto it = find(curTurns.begin(), curTurns.end(), hash_move);
+                if (it != curTurns.end())
+                    swap(*it, curTurns[0]);
+            }
+        }
+
+        // Если нет доступных ходов - это поражение
+        if (count == 0)
+        {
+            return (Is_max ? loss_score(ply) : win_score(ply));
+        }
+
+        // Если все ходы ведут в листья - оцениваем их одним пакетом без копирования доски
+        const bool batch_leaves = (Mode == Scoring::NumberOnly || Mode == Scoring::NumberAndPotential) &&
+                                  batch_enabled && !cur_have_beats && depth + 1 == size_t(Max_depth) &&
+                                  curTurns.size() <= Batch_eval::Capacity;
+        if (batch_leaves)
+        {
+            leaf_batch.clear(mtx);
+            for (auto turn : curTurns)
+            {
+                leaf_batch.add(turn);
+            }
+            leaf_batch.evaluate(Mode == Scoring::NumberAndPotential, Is_max == Color);
+            nodes += curTurns.size();
+        }
+
+        double min_score = INF + 1;  // Минимальная оценка для MIN-игрока
+        double max_score = -1;       // Максимальная оценка для MAX-игрока
+        size_t best_k = 0;           // индекс лучшего хода
+        bool closed = false;         // окно альфа-бета схлопнулось
+
+        // Перебор всех возможных ходов
+        for (size_t k = 0; k < count; ++k)
+        {
+            double score = 0.0;
+
+            // Оценка листа уже посчитана пакетом; тихий ход дамки может повторить позицию пути -
+            // это ничья, как в листе, оценённом отдельно
+            if (batch_leaves)
+            {
+                const move_pos& turn = curTurns[k];
+                const POS_T type = mtx[turn.x][turn.y];
+                if (type > 2 && is_repetition(Zobrist::quiet_move(pos_key, type, turn.x, turn.y, turn.x2, turn.y2)))
+                    score = Draw_score;
+                else
+                    score = at_ply(leaf_batch.score[k], ply + 1);
+            }
+            // Серия взятий целиком - один ход, затем ходит противник
+            else if (cur_have_beats)
+            {
+                if constexpr (Mode == Scoring::NNUE)
+                    push_series(mtx, cur_series[k].steps);
+                score = find_best_turns_rec<!Color, !Is_max, Opt, Mode>(cur_series[k].mtx, depth + 1, alpha, beta);
+                if constexpr (Mode == Scoring::NNUE)
+                    pop_series(cur_series[k].steps);
+            }
+            else  // Иначе передаем ход противнику
+            {
+                auto turn = curTurns[k];
+                if constexpr (Mode == Scoring::NNUE)
+                    nnue.push(mtx, turn);
+                score = find_best_turns_rec<!Color, !Is_max, Opt, Mode>(make_turn(mtx, turn), depth + 1, alpha, beta,
+                                                                        mtx[turn.x][turn.y] > 2);
+                if constexpr (Mode == Scoring::NNUE)
+                    nnue.pop();
+            }
+
+            // Обновляем минимальную и максимальную оценки
+            if ((Is_max && score > max_score) || (!Is_max && score < min_score))
+                best_k = k;
+            min_score = min(min_score, score);
+            max_score = max(max_score, score);
+
+            // Альфа-бета отсечение
+            if constexpr (Is_max)
+                alpha = max(alpha, max_score);
+            else
+                beta = min(beta, min_score);
+
+            // Прекращаем перебор при выполнении условия отсечения
+            if constexpr (Opt != Optimization::O0)
+            {
+                if (alpha > beta)
+                    break;
+            }
+
+            // Дополнительное отсечение при равенстве альфа и бета
+            if constexpr (Opt != Optimization::O2)
+            {
+                if (alpha == beta)
+                {
+                    closed = true;
+                    break;
+                }
+            }
+        }
+
+        // Возвращаем оптимальную оценку в зависимости от глубины
+        const double res = closed ? (Is_max ? max_score + 1 : min_score - 1) : (Is_max ? max_score : min_score);
+        if (use_hash && !aborted && alpha_start < beta_start)
+        {
+            // Оценки за окном завышены отсечением при равенстве альфа и бета,
+            // поэтому в таблицу идут сами границы окна (при пустом окне направление границы неизвестно)
+            const move_pos best_move = cur_have_beats ? cur_series[best_k].steps[0] : curTurns[best_k];
+            if (res <= alpha_start)
+                hash->store(key, remaining, to_hash(alpha_start, ply), Hash_table::Upper, best_move);
+            else if (res >= beta_start)
+                hash->store(key, remaining, to_hash(beta_start, ply), Hash_table::Lower, best_move);
+            else
+                hash->store(key, remaining, to_hash(res, ply), Hash_table::Exact, best_move);
+        }
+        return res;
+    }
+     
+public:
+    // поиск возможных ходов для определенного цвета
+    void find_turns(const bool color, const Position& mtx)
+    {
+        if (color)
+            find_turns<true>(mtx);
+        else
+            find_turns<false>(mtx);
+    }
+
+    // Лучший ход позиции mtx (цвет color) из таблицы перестановок последнего поиска - первый шаг
+    // серии взятий; x == -1 - записи нет. is_max - ходит бот (ключи таблицы различают стороны)
+    move_pos hash_move(const Position& mtx, const bool color, const bool is_max) const
+    {
+        Hash_table::Entry entry;
+        if (!hash || !hash->probe(Zobrist::hash(mtx, color) ^ hash_salt ^ (is_max ? Zobrist::salt(1) : 0), entry))
+            return move_pos(-1, -1, -1, -1);
+        return entry.move();
+    }
+
+private:
+    // основной метод для поиска ходов по цвету
+    template <bool Color> void find_turns(const Position& mtx)
+    {
+        vector<move_pos> res_turns;
+        bool have_beats_before = false;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (mtx[i][j] && mtx[i][j] % 2 != Color)
+                {
+                    find_turns(i, j, mtx);
+                    if (have_beats && !have_beats_before)
+                    {
+                        have_beats_before = true;
+                        res_turns.clear();
+                    }
+                    if ((have_beats_before && have_beats) || !have_beats_before)
+                    {
+                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
+                    }
+                }
+            }
+        }
+        turns = res_turns;
+        shuffle(turns.begin(), turns.end(), rand_eng);
+        have_beats = have_beats_before;
+    }
+
+public:
+    // тоже самое но для конкретной позиции
+    void find_turns(const POS_T x, const POS_T y, const Position& mtx)
+    {
+        turns.clear();
+        have_beats = false;
+        POS_T type = mtx[x][y];
+        // check beats
+        switch (type)
+        {
+        case 1:
+        case 2:
+            // check pieces
+            for (POS_T i = x - 2; i <= x + 2; i += 4)
+            {
+                for (POS_T j = y - 2; j <= y + 2; j += 4)
+                {
+                    if (i < 0 || i > 7 || j < 0 || j > 7)
+                        continue;
+                    POS_T xb = (x + i) / 2, yb = (y + j) / 2;
+                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
+                        continue;
+                    turns.emplace_back(x, y, i, j, xb, yb);
+                }
+            }
+            break;
+        default:
+            // check queens
+            for (POS_T i = -1; i <= 1; i += 2)
+            {
+                for (POS_T j = -1; j <= 1; j += 2)
+                {
+                    POS_T xb = -1, yb = -1;
+                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
+                    {
+                        if (mtx[i2][j2])
+                        {
+                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1))
+                            {
+                                break;
+                            }
+                            xb = i2;
+                            yb = j2;
+                        }
+                        if (xb != -1 && xb != i2)
+                        {
+                            turns.emplace_back(x, y, i2, j2, xb, yb);
+                        }
+                    }
+                }
+            }
+            break;
+        }
+        // check other turns
+        if (!turns.empty())
+        {
+            have_beats = true;
+            return;
+        }
+        switch (type)
+        {
+        case 1:
+        case 2:
+            // check pieces
+        {
+            POS_T i = ((type % 2) ? x - 1 : x + 1);
+            for (POS_T j = y - 1; j <= y + 1; j += 2)
+            {
+                if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
+                    continue;
+                turns.emplace_back(x, y, i, j);
+            }
+            break;
+        }
+        default:
+            // check queens
+            for (POS_T i = -1; i <= 1; i += 2)
+            {
+                for (POS_T j = -1; j <= 1; j += 2)
+                {
+                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
+                    {
+                        if (mtx[i2][j2])
+                            break;
+                        turns.emplace_back(x, y, i2, j2);
+                    }
+                }
+            }
+            break;
+        }
+    }
+
+public:
+    vector<move_pos> turns; // возможные ходы
+    bool have_beats; // есть ли побитие
+    int Max_depth; // максимальная глубина поиска
+    double best_score = 0; // оценка лучшего хода последнего поиска
+    int64_t nodes = 0; // количество узлов, просмотренных с последнего set_limits
+    int cache_hit_depth = -1; // глубина записи кэша, из которой взят последний ход (-1 - был поиск)
+    int plies_left = 120; // полуходов до ничьей по лимиту ходов (предел решателя)
+    Solve_status solver_status = Solve_status::Unknown; // итог решателя в последнем ходе
+    int solver_length = 0; // полуходов до конца партии по решателю
+
+private:
+    Bot_options options; // настройки, с которыми загружены ресурсы (configure)
+    default_random_engine rand_eng; // генератор случайных чисел
+    Scoring scoring_mode = Scoring::NumberAndPotential; // режим подсчета очков
+    Optimization optimization = Optimization::O1; // оптимизация
+    NNUE nnue; // нейросетевая оценка (BotScoringType = "NNUE")
+    Ntuple ntuple; // оценка n-кортежами (BotScoringType = "NTuple")
+    Batch_eval leaf_batch; // буфер пакетной оценки листьев
+    bool batch_enabled = true; // листья оцениваются пакетом (Bot_options::batch_leaves)
+    vector<move_pos> best_turn; // лучший ход в корне (серия взятий целиком)
+    vector<Path_entry> game_path; // позиции партии (set_history)
+    vector<Path_entry> path; // позиции от начала партии до текущего узла перебора
+    const atomic<bool>* stop_flag = nullptr; // внешний флаг остановки (nullptr - без ограничений)
+    int64_t max_nodes = 0; // лимит узлов
+    chrono::steady_clock::time_point stop_time = chrono::steady_clock::time_point::max(); // лимит времени
+    bool aborted = false; // поиск прерван
+    Hash_table* hash = nullptr; // таблица перестановок (nullptr - без таблицы)
+    uint64_t hash_salt = 0; // ключ настроек поиска
+    shared_ptr<Position_cache> cache; // постоянный кэш позиций (общий у копий Logic)
+    int solver_pieces = 0; // решатель включается при стольких шашках и меньше
+    int64_t solver_ms = 0; // время решателя на ход
+    shared_ptr<Proof_solver<Logic_rules>> solver; // решатель форсированных выигрышей (nullptr - выключен)
+    uint64_t solved_key = 0; // позиция последнего решения
+    vector<move_pos> solver_turn; // доказанный выигрывающий ход в этой позиции
+    int64_t mcts_ms = 0; // время MCTS на ход без внешних ограничений
+    shared_ptr<Mcts<Logic_rules>> mcts; // поиск Монте-Карло (nullptr - перебор)
+    Search_stats* stats = nullptr; // публикация хода поиска для окна
+    int64_t stats_base = 0; // значение nodes в начале поиска
+};
\ No newline at end of file
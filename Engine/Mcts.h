@@ -0,0 +1,278 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "Rules.h"
+
+using namespace std;
+
+// Результат поиска MCTS: ход с наибольшим числом посещений и его доля выигрышей
+struct Mcts_result
+{
+    Variant_move move;
+    bool found = false;
+    double win_rate = 0.5; // с точки зрения ходящего
+    int64_t playouts = 0;
+    int64_t nodes = 0;     // занято узлов пула
+    int64_t time_ms = 0;
+};
+
+// Поиск по дереву методом Монте-Карло (UCT) с распараллеливанием по дереву: все потоки спускаются
+// по общему дереву, а виртуальные потери на пройденном пути уводят остальные потоки в другие ветви.
+// Узлы берутся из заранее выделенного пула (без выделений памяти во время поиска), пул
+// переиспользуется каждым поиском; при заполнении пула дерево перестаёт расти, а розыгрыши
+// продолжаются из листьев. Розыгрыш - случайные ходы до Playout_plies полуходов, затем
+// материальная оценка переводится в вероятность выигрыша
+template <class Rules> class Mcts
+{
+public:
+    using Gen = Move_generator<Rules>;
+    using G = Geometry<Rules::Size>;
+
+    static const int Playout_plies = 24;
+    static const int Virtual_loss = 3;
+
+    explicit Mcts(const size_t bytes = size_t(64) << 20, const int thread_count = 0)
+        : pool(max<size_t>(bytes / sizeof(Node), 1024)),
+          threads(thread_count > 0 ? thread_count : int(max(1u, thread::hardware_concurrency())))
+    {
+    }
+
+    // Остановка из другого потока
+    void stop()
+    {
+        stop_flag = true;
+    }
+
+    // Поиск: time_ms и playout_limit - бюджет (0 - без ограничения, но хотя бы одно нужно),
+    // max_plies - полуходов до ничьей по лимиту, external_stop - внешний флаг остановки
+    Mcts_result search(const Variant_position& pos, const int64_t time_ms, const int64_t playout_limit,
+                       const int max_plies, const atomic<bool>* external_stop = nullptr)
+    {
+        const auto start = chrono::steady_clock::now();
+        const auto deadline =
+            time_ms ? start + chrono::milliseconds(time_ms) : chrono::steady_clock::time_point::max();
+        stop_flag = false;
+        playouts = 0;
+        used = 1;
+        pool[0].reset(pos, Variant_move());
+        Mcts_result res;
+        Move_list root_moves;
+        Gen::generate(pos, root_moves);
+        if (!root_moves.size)
+            return res;
+        if (root_moves.size == 1)
+        {
+            res.move = root_moves.moves[0];
+            res.found = true;
+            return res;
+        }
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                uint64_t rng = 0x9E3779B97F4A7C15ULL * uint64_t(t + 1) ^ uint64_t(start.time_since_epoch().count());
+                for (int k = 0; !stop_flag.load(memory_order_relaxed); ++k)
+                {
+                    if ((external_stop && external_stop->load(memory_order_relaxed)) ||
+                        (playout_limit && playouts.load(memory_order_relaxed) >= playout_limit) ||
+                        ((k & 63) == 0 && chrono::steady_clock::now() >= deadline))
+                    {
+                        stop_flag = true;
+                        break;
+                    }
+                    iterate(max_plies, rng);
+                    playouts.fetch_add(1, memory_order_relaxed);
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+
+        const Node& root = pool[0];
+        uint32_t best_visits = 0;
+        for (uint32_t k = 0; k < root.count; ++k)
+        {
+            const Node& c = pool[root.first + k];
+            const uint32_t v = c.visits.load();
+            if (v > best_visits)
+            {
+                best_visits = v;
+                res.move = c.move;
+                res.win_rate = double(c.value.load()) / Scale / v;
+                res.found = true;
+            }
+        }
+        if (!res.found)
+        {
+            res.move = root_moves.moves[0];
+            res.found = true;
+        }
+        res.playouts = playouts;
+        res.nodes = int64_t(min<size_t>(used.load(), pool.size()));
+        res.time_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        return res;
+    }
+
+private:
+    static const int64_t Scale = 1000; // награда 0..1 в фиксированной точке
+
+    struct Node
+    {
+        Variant_position pos;
+        Variant_move move;               // ход, ведущий в узел
+        atomic<uint32_t> visits{0};
+        atomic<uint32_t> virtual_loss{0};
+        atomic<int64_t> value{0};        // сумма наград для стороны, сделавшей ход в узел
+        atomic<uint8_t> state{0};        // 0 - не раскрыт, 1 - раскрывается, 2 - раскрыт
+        uint32_t first = 0;              // индекс первого ребёнка в пуле
+        uint32_t count = 0;              // количество детей (0 у раскрытого узла - конец партии)
+
+        void reset(const Variant_position& p, const Variant_move& m)
+        {
+            pos = p;
+            move = m;
+            visits.store(0, memory_order_relaxed);
+            virtual_loss.store(0, memory_order_relaxed);
+            value.store(0, memory_order_relaxed);
+            first = count = 0;
+            state.store(0, memory_order_release);
+        }
+    };
+
+    static uint64_t next_random(uint64_t& s)
+    {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        return s;
+    }
+
+    // Один спуск: выбор по UCT, раскрытие, розыгрыш, обратное распространение
+    void iterate(const int max_plies, uint64_t& rng)
+    {
+        uint32_t path[512];
+        int length = 0;
+        uint32_t cur = 0;
+        path[length++] = cur;
+        pool[cur].virtual_loss.fetch_add(Virtual_loss, memory_order_relaxed);
+        while (length <= max_plies && length < 511)
+        {
+            Node& n = pool[cur];
+            if (n.state.load(memory_order_acquire) != 2)
+            {
+                if (!expand(n))
+                    break;
+            }
+            if (!n.count)
+                break;
+            cur = select(n);
+            path[length++] = cur;
+            pool[cur].virtual_loss.fetch_add(Virtual_loss, memory_order_relaxed);
+            if (pool[cur].visits.load(memory_order_relaxed) == 0)
+                break;
+        }
+        const Node& leaf = pool[cur];
+        // награда с точки зрения стороны, ходящей в листе
+        double reward = playout(leaf.pos, max_plies - (length - 1), rng);
+        for (int k = length - 1; k >= 0; --k)
+        {
+            Node& n = pool[path[k]];
+            // value узла - для стороны, которая в него сходила, т.е. противника ходящего в узле
+            n.value.fetch_add(int64_t((1 - reward) * Scale), memory_order_relaxed);
+            n.visits.fetch_add(1, memory_order_relaxed);
+            n.virtual_loss.fetch_sub(Virtual_loss, memory_order_relaxed);
+            reward = 1 - reward;
+        }
+    }
+
+    // Раскрытие узла одним потоком; false - узел раскрывает другой поток или пул заполнен
+    bool expand(Node& n)
+    {
+        uint8_t expected = 0;
+        if (!n.state.compare_exchange_strong(expected, 1, memory_order_acq_rel))
+            return expected == 2;
+        Move_list list;
+        Gen::generate(n.pos, list);
+        const size_t first = used.fetch_add(size_t(list.size), memory_order_relaxed);
+        if (first + size_t(list.size) > pool.size())
+        {
+            // пул заполнен: узел остаётся листом навсегда в этом поиске
+            n.state.store(0, memory_order_release);
+            return false;
+        }
+        for (int k = 0; k < list.size; ++k)
+            pool[first + k].reset(Gen::apply(n.pos, list.moves[k]), list.moves[k]);
+        n.first = uint32_t(first);
+        n.count = uint32_t(list.size);
+        n.state.store(2, memory_order_release);
+        return true;
+    }
+
+    // UCT с виртуальными потерями: незаконченные спуски считаются проигрышами
+    uint32_t select(const Node& n) const
+    {
+        const double parent = double(n.visits.load(memory_order_relaxed) + n.virtual_loss.load(memory_order_relaxed));
+        const double log_parent = log(parent + 1);
+        double best = -1;
+        uint32_t res = n.first;
+        for (uint32_t k = 0; k < n.count; ++k)
+        {
+            const Node& c = pool[n.first + k];
+            const double visits = double(c.visits.load(memory_order_relaxed));
+            const double seen = visits + c.virtual_loss.load(memory_order_relaxed);
+            if (seen == 0)
+                return n.first + k;
+            const double q = double(c.value.load(memory_order_relaxed)) / Scale / seen;
+            const double score = q + 1.4 * sqrt(log_parent / seen);
+            if (score > best)
+            {
+                best = score;
+                res = n.first + k;
+            }
+        }
+        return res;
+    }
+
+    // Случайная партия из pos: 1 - выигрыш ходящего, 0 - проигрыш, 0.5 - ничья по лимиту
+    static double playout(Variant_position pos, const int plies_left, uint64_t& rng)
+    {
+        const bool side = pos.color;
+        Move_list list;
+        for (int ply = 0; ply < Playout_plies; ++ply)
+        {
+            Gen::generate(pos, list);
+            if (!list.size)
+                return pos.color == side ? 0 : 1;
+            if (ply >= plies_left)
+                return 0.5;
+            pos = Gen::apply(pos, list.moves[next_random(rng) % uint64_t(list.size)]);
+        }
+        // оценка материала: дамка - Rules::King_value, шашка - 100
+        auto material = [](const uint64_t own, const uint64_t kings) {
+            return 100 * popcount(own & ~kings) + Rules::King_value * popcount(own & kings);
+        };
+        const int diff = material(side ? pos.black : pos.white, pos.kings) -
+                         material(side ? pos.white : pos.black, pos.kings);
+        return 1 / (1 + exp(-diff / 150.0));
+    }
+
+    static int popcount(uint64_t mask)
+    {
+        int res = 0;
+        for (; mask; mask &= mask - 1)
+            ++res;
+        return res;
+    }
+
+    vector<Node> pool;
+    atomic<size_t> used{0};
+    int threads;
+    atomic<bool> stop_flag{false};
+    atomic<int64_t> playouts{0};
+};
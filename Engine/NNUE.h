@@ -0,0 +1,351 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NNUE_SSE2
+#endif
+
+#include "../Models/Position.h"
+#include "Shared_memory.h"
+
+using namespace std;
+
+// Небольшая квантованная нейросеть для оценки позиции (NNUE).
+// Вход - 128 признаков: 32 тёмные клетки x 4 типа фигур.
+// Первый слой (int16) хранится в аккумуляторе и обновляется инкрементально при каждом ходе,
+// остальные слои (int8) пересчитываются только в листьях дерева поиска.
+class NNUE
+{
+public:
+    static const int Inputs = 128;  // количество входных признаков
+    static const int Hidden = 128;  // размер аккумулятора
+    static const int Hidden2 = 32;  // размер второго скрытого слоя
+    static const int Act_max = 127; // верхняя граница clipped ReLU
+    static const int Weight_shift = 6; // int8 веса хранятся умноженными на 2^6
+    static const int Score_scale = 100; // единицы оценки в position_sample::score
+
+    // Состояние первого слоя для одной позиции
+    struct Accumulator
+    {
+        alignas(32) int16_t v[Hidden];
+        int pieces[2]; // количество белых и черных фигур
+    };
+
+    // Веса в изменяемом виде: заполняются тренером и сохраняются в файл сети
+    struct Weights
+    {
+        vector<int16_t> b1, w1;
+        vector<int32_t> b2, b3;
+        vector<int8_t> w2, w3;
+
+        void allocate()
+        {
+            b1.assign(Hidden, 0);
+            w1.assign(Inputs * Hidden, 0);
+            b2.assign(Hidden2, 0);
+            w2.assign(Hidden2 * Hidden, 0);
+            b3.assign(1, 0);
+            w3.assign(Hidden2, 0);
+        }
+
+        bool save(const string& path) const
+        {
+            ofstream fout(path, ios::binary);
+            const uint32_t header[4] = {Version, Inputs, Hidden, Hidden2};
+            fout.write("CKNN", 4);
+            fout.write(reinterpret_cast<const char*>(header), sizeof(header));
+            write_array(fout, b1);
+            write_array(fout, w1);
+            write_array(fout, b2);
+            write_array(fout, w2);
+            write_array(fout, b3);
+            write_array(fout, w3);
+            return bool(fout);
+        }
+    };
+
+    // Загрузка сети из бинарного файла, возвращает false при ошибке формата.
+    // shared - веса кладутся в общую память и не дублируются в процессах с той же сетью
+    bool load(const string& path, const bool shared = false)
+    {
+        loaded = false;
+        ifstream fin(path, ios::binary | ios::ate);
+        if (!fin)
+            return false;
+        auto file = make_shared<vector<char>>(size_t(fin.tellg()));
+        fin.seekg(0);
+        fin.read(file->data(), file->size());
+        if (!fin || !check_format(file->data(), file->size()))
+            return false;
+        digest = content_hash(file->data(), file->size());
+        if (shared)
+        {
+            // имя сегмента - хеш содержимого: новая сеть попадает в новый сегмент
+            char name[64];
+            snprintf(name, sizeof(name), "/checkers-nnue-%016llx", (unsigned long long)digest);
+            auto mem = make_shared<Shared_memory>();
+            if (mem->open(
+                    name, file->size(),
+                    [&](char* data) {
+                        memcpy(data, file->data(), file->size());
+                        return true;
+                    },
+                    false) &&
+                memcmp(mem->data(), file->data(), file->size()) == 0)
+            {
+                attach(mem->data());
+                storage = mem;
+                loaded = true;
+                return true;
+            }
+        }
+        attach(file->data());
+        storage = file;
+        loaded = true;
+        return true;
+    }
+
+    bool is_loaded() const
+    {
+        return loaded;
+    }
+
+    // Хеш содержимого загруженного файла сети
+    uint64_t weights_hash() const
+    {
+        return digest;
+    }
+
+    // Номер признака для фигуры type (1..4) на клетке (i, j)
+    static int feature(const POS_T type, const POS_T i, const POS_T j)
+    {
+        return (type - 1) * 32 + i * 4 + j / 2;
+    }
+
+    // Полный пересчёт аккумулятора для корня поиска
+    void refresh(const Position& mtx)
+    {
+        ply = 0;
+        if (stack.empty())
+            stack.resize(64);
+        Accumulator& acc = stack[0];
+        copy(b1, b1 + Hidden, acc.v);
+        acc.pieces[0] = acc.pieces[1] = 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (!mtx[i][j])
+                    continue;
+                add_row(acc.v, feature(mtx[i][j], i, j));
+                ++acc.pieces[1 - mtx[i][j] % 2];
+            }
+        }
+    }
+
+    // Инкрементальное обновление при ходе turn из позиции mtx
+    void push(const Position& mtx, const move_pos& turn)
+    {
+        if (ply + 1 == int(stack.size()))
+            stack.resize(stack.size() * 2);
+        const Accumulator& src = stack[ply];
+        Accumulator& dst = stack[++ply];
+        POS_T type = mtx[turn.x][turn.y];
+        int rem[2] = {feature(type, turn.x, turn.y), -1};
+        if ((type == 1 && turn.x2 == 0) || (type == 2 && turn.x2 == 7))
+            type += 2;
+        dst.pieces[0] = src.pieces[0];
+        dst.pieces[1] = src.pieces[1];
+        if (turn.xb != -1)
+        {
+            rem[1] = feature(mtx[turn.xb][turn.yb], turn.xb, turn.yb);
+            --dst.pieces[1 - mtx[turn.xb][turn.yb] % 2];
+        }
+        update(dst.v, src.v, feature(type, turn.x2, turn.y2), rem[0], rem[1]);
+    }
+
+    // Отмена последнего хода
+    void pop()
+    {
+        --ply;
+    }
+
+    // Количество фигур цвета color в текущей позиции
+    int pieces(const bool color) const
+    {
+        return stack[ply].pieces[color];
+    }
+
+    // Оценка текущей позиции: ln(отношения сил) с точки зрения белых
+    double evaluate() const
+    {
+        alignas(32) uint8_t h1[Hidden];
+        clipped_relu(stack[ply].v, h1);
+        int32_t out = b3[0];
+        for (int m = 0; m < Hidden2; ++m)
+        {
+            int32_t sum = (b2[m] + dot(h1, &w2[m * Hidden])) >> Weight_shift;
+            out += min(max(sum, 0), Act_max) * w3[m];
+        }
+        return double(out) / (Act_max << Weight_shift);
+    }
+
+private:
+    // acc += w1[f]
+    void add_row(int16_t* acc, const int f) const
+    {
+        const int16_t* w = &w1[f * Hidden];
+        for (int k = 0; k < Hidden; ++k)
+            acc[k] += w[k];
+    }
+
+    // dst = src + w1[add] - w1[rem1] - w1[rem2] (rem2 может отсутствовать)
+    void update(int16_t* dst, const int16_t* src, const int add, const int rem1, const int rem2) const
+    {
+        const int16_t* wa = &w1[add * Hidden];
+        const int16_t* wr = &w1[rem1 * Hidden];
+        const int16_t* wc = (rem2 != -1 ? &w1[rem2 * Hidden] : nullptr);
+#if defined(__AVX2__)
+        for (int k = 0; k < Hidden; k += 16)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + k));
+            v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wa + k)));
+            v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wr + k)));
+            if (wc)
+                v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wc + k)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), v);
+        }
+#elif defined(NNUE_SSE2)
+        for (int k = 0; k < Hidden; k += 8)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k));
+            v = _mm_add_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(wa + k)));
+            v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(wr + k)));
+            if (wc)
+                v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(wc + k)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), v);
+        }
+#else
+        for (int k = 0; k < Hidden; ++k)
+            dst[k] = int16_t(src[k] + wa[k] - wr[k] - (wc ? wc[k] : 0));
+#endif
+    }
+
+    // Clipped ReLU первого слоя: int16 -> uint8 в диапазоне [0, 127]
+    static void clipped_relu(const int16_t* acc, uint8_t* out)
+    {
+#if defined(__AVX2__)
+        const __m256i top = _mm256_set1_epi8(Act_max);
+        for (int k = 0; k < Hidden; k += 32)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + k));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + k + 16));
+            // packus перемешивает 128-битные половины, восстанавливаем порядок
+            __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_min_epu8(p, top));
+        }
+#elif defined(NNUE_SSE2)
+        const __m128i top = _mm_set1_epi8(Act_max);
+        for (int k = 0; k < Hidden; k += 16)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + k));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + k + 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + k), _mm_min_epu8(_mm_packus_epi16(a, b), top));
+        }
+#else
+        for (int k = 0; k < Hidden; ++k)
+            out[k] = uint8_t(min(max(int(acc[k]), 0), Act_max));
+#endif
+    }
+
+    // Скалярное произведение активаций uint8 на веса int8
+    static int32_t dot(const uint8_t* h, const int8_t* w)
+    {
+#if defined(__AVX2__)
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i sum = _mm256_setzero_si256();
+        for (int k = 0; k < Hidden; k += 32)
+        {
+            __m256i hv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + k));
+            __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + k));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(hv, wv), ones));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        return _mm_cvtsi128_si32(s);
+#elif defined(NNUE_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        for (int k = 0; k < Hidden; k += 16)
+        {
+            __m128i hv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + k));
+            __m128i wv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + k));
+            // расширение до int16: активации без знака, веса со знаком
+            __m128i wl = _mm_srai_epi16(_mm_unpacklo_epi8(wv, wv), 8);
+            __m128i wh = _mm_srai_epi16(_mm_unpackhi_epi8(wv, wv), 8);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(hv, zero), wl));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(hv, zero), wh));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+#else
+        int32_t sum = 0;
+        for (int k = 0; k < Hidden; ++k)
+            sum += int32_t(h[k]) * w[k];
+        return sum;
+#endif
+    }
+
+    static const size_t Header_size = 4 + 4 * sizeof(uint32_t);
+    static const size_t File_size = Header_size + Hidden * 2 + Inputs * Hidden * 2 + Hidden2 * 4 + Hidden2 * Hidden +
+                                    4 + Hidden2;
+
+    static bool check_format(const char* data, const size_t size)
+    {
+        uint32_t header[4];
+        if (size != File_size || memcmp(data, "CKNN", 4) != 0)
+            return false;
+        memcpy(header, data + 4, sizeof(header));
+        return header[0] == Version && header[1] == Inputs && header[2] == Hidden && header[3] == Hidden2;
+    }
+
+    // Веса читаются прямо из образа файла (массивы int32 в нём выровнены на 4 байта)
+    void attach(const char* data)
+    {
+        data += Header_size;
+        b1 = reinterpret_cast<const int16_t*>(data);
+        w1 = b1 + Hidden;
+        b2 = reinterpret_cast<const int32_t*>(w1 + Inputs * Hidden);
+        w2 = reinterpret_cast<const int8_t*>(b2 + Hidden2);
+        b3 = reinterpret_cast<const int32_t*>(w2 + Hidden2 * Hidden);
+        w3 = reinterpret_cast<const int8_t*>(b3 + 1);
+    }
+
+    template <class T> static void write_array(ofstream& fout, const vector<T>& v)
+    {
+        fout.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+    }
+
+    static const uint32_t Version = 1;
+
+    // Квантованные веса: первый слой в int16, остальные в int8 со смещениями int32.
+    // Указывают в storage - образ файла в памяти процесса или в общей памяти
+    const int16_t *b1 = nullptr, *w1 = nullptr;
+    const int32_t *b2 = nullptr, *b3 = nullptr;
+    const int8_t *w2 = nullptr, *w3 = nullptr;
+    shared_ptr<const void> storage;
+    bool loaded = false;
+    uint64_t digest = 0;
+    vector<Accumulator> stack; // аккумуляторы вдоль текущего пути поиска
+    int ply = 0;               // текущая глубина в stack
+};
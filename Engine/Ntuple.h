@@ -0,0 +1,220 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "Rules.h"
+#include "Shared_memory.h"
+
+using namespace std;
+
+// Оценка позиции n-кортежами: много маленьких таблиц, каждая индексируется содержимым
+// нескольких тёмных клеток (кортежа). Клетка кодируется как в Board: 0 - пусто, 1..4 - фигуры,
+// поэтому таблица кортежа из 4 клеток - 5^4 = 625 весов. Оценка - сумма весов позиции минус
+// сумма весов той же позиции, повёрнутой на 180 градусов со сменой цветов: так она
+// антисимметрична, и веса одинаково учат обе стороны. Результат - ln(отношения сил) с точки
+// зрения белых, как у NNUE. Веса обучает Tools/ntuple_trainer.cpp.
+class Ntuple
+{
+public:
+    static const int Length = 4;   // клеток в кортеже
+    static const int States = 5;   // состояний клетки
+    static const int Entries = 625; // States ^ Length - размер таблицы кортежа
+    static const int Weight_scale = 1024; // int16 веса хранятся умноженными на 1024
+    static const int Squares = 32;
+
+    using Tuple = array<uint8_t, Length>; // номера клеток i * 4 + j / 2
+
+    // Веса в изменяемом виде: заполняются тренером и сохраняются в файл
+    struct Weights
+    {
+        vector<Tuple> tuples;
+        vector<int16_t> w; // tuples.size() таблиц по Entries весов
+
+        bool save(const string& path) const
+        {
+            ofstream fout(path, ios::binary);
+            const uint32_t header[4] = {Version, uint32_t(tuples.size()), Length, States};
+            fout.write("CKNT", 4);
+            fout.write(reinterpret_cast<const char*>(header), sizeof(header));
+            fout.write(reinterpret_cast<const char*>(tuples.data()), tuples.size() * sizeof(Tuple));
+            fout.write(reinterpret_cast<const char*>(w.data()), w.size() * sizeof(int16_t));
+            return bool(fout);
+        }
+
+        // Чтение файла весов (для продолжения обучения)
+        bool load(const string& path)
+        {
+            ifstream fin(path, ios::binary | ios::ate);
+            if (!fin)
+                return false;
+            vector<char> file(size_t(fin.tellg()));
+            fin.seekg(0);
+            fin.read(file.data(), file.size());
+            const Tuple* t;
+            const int16_t* data;
+            size_t count;
+            if (!fin || !parse(file.data(), file.size(), t, data, count))
+                return false;
+            tuples.assign(t, t + count);
+            w.assign(data, data + count * Entries);
+            return true;
+        }
+    };
+
+    // Стандартный набор кортежей: ромбы 2x2 на тёмных клетках и отрезки диагоналей из 4 клеток
+    static vector<Tuple> standard_tuples()
+    {
+        vector<Tuple> res;
+        auto square = [](const int i, const int j) { return uint8_t(i * 4 + j / 2); };
+        for (int i = 0; i + 2 < 8; ++i)
+            for (int j = 1; j + 1 < 8; ++j)
+                if ((i + j) % 2 == 1)
+                    res.push_back({square(i, j), square(i + 1, j - 1), square(i + 1, j + 1), square(i + 2, j)});
+        for (int dj = -1; dj <= 1; dj += 2)
+            for (int i = 0; i + 3 < 8; ++i)
+                for (int j = 0; j < 8; ++j)
+                    if ((i + j) % 2 == 1 && j + 3 * dj >= 0 && j + 3 * dj < 8)
+                        res.push_back({square(i, j), square(i + 1, j + dj), square(i + 2, j + 2 * dj),
+                                       square(i + 3, j + 3 * dj)});
+        return res;
+    }
+
+    // Загрузка весов: файл отображается в память (без POSIX - читается целиком),
+    // false при ошибке формата
+    bool load(const string& path)
+    {
+        loaded = false;
+        auto mapped = shared_ptr<Mapped_file>(new Mapped_file(), [](Mapped_file* f) {
+            f->close();
+            delete f;
+        });
+        if (mapped->open(path))
+        {
+            if (!attach(mapped->base, mapped->length))
+                return false;
+            digest = content_hash(mapped->base, mapped->length);
+            storage = mapped;
+            loaded = true;
+            return true;
+        }
+        ifstream fin(path, ios::binary | ios::ate);
+        if (!fin)
+            return false;
+        auto file = make_shared<vector<char>>(size_t(fin.tellg()));
+        fin.seekg(0);
+        fin.read(file->data(), file->size());
+        if (!fin || !attach(file->data(), file->size()))
+            return false;
+        digest = content_hash(file->data(), file->size());
+        storage = file;
+        loaded = true;
+        return true;
+    }
+
+    bool is_loaded() const
+    {
+        return loaded;
+    }
+
+    // Хеш содержимого загруженного файла весов
+    uint64_t weights_hash() const
+    {
+        return digest;
+    }
+
+    // Клетки позиции mtx в порядке номеров; pieces - количество белых и черных фигур
+    static void states(const Position& mtx, uint8_t* s, int* pieces)
+    {
+        pieces[0] = pieces[1] = 0;
+        for (int b = 0; b < Squares; ++b)
+        {
+            const int i = b / 4;
+            s[b] = uint8_t(mtx[i][2 * (b % 4) + (i % 2 == 0 ? 1 : 0)]);
+            if (s[b])
+                ++pieces[1 - s[b] % 2];
+        }
+    }
+
+    // То же для позиции генератора ходов (номера клеток совпадают с битами to_variant)
+    static void states(const Variant_position& pos, uint8_t* s)
+    {
+        for (int b = 0; b < Squares; ++b)
+        {
+            const uint64_t bit = 1ULL << b;
+            const int king = (pos.kings & bit) ? 2 : 0;
+            s[b] = uint8_t((pos.white & bit) ? 1 + king : ((pos.black & bit) ? 2 + king : 0));
+        }
+    }
+
+    // Позиция, повёрнутая на 180 градусов со сменой цветов
+    static void mirror(const uint8_t* s, uint8_t* m)
+    {
+        static const uint8_t swap_color[States] = {0, 2, 1, 4, 3};
+        for (int b = 0; b < Squares; ++b)
+            m[b] = swap_color[s[Squares - 1 - b]];
+    }
+
+    // Номер веса в таблице кортежа t
+    static int index(const uint8_t* s, const Tuple& t)
+    {
+        int res = 0;
+        for (int k = 0; k < Length; ++k)
+            res = res * States + s[t[k]];
+        return res;
+    }
+
+    // Оценка позиции s: ln(отношения сил) с точки зрения белых
+    double evaluate(const uint8_t* s) const
+    {
+        uint8_t m[Squares];
+        mirror(s, m);
+        int32_t sum = 0;
+        const int16_t* table = w;
+        for (size_t t = 0; t < tuple_count; ++t, table += Entries)
+            sum += table[index(s, tuples[t])] - table[index(m, tuples[t])];
+        return double(sum) / Weight_scale;
+    }
+
+private:
+    static const uint32_t Version = 1;
+    static const size_t Header_size = 4 + 4 * sizeof(uint32_t);
+
+    // Проверка формата и указатели на кортежи и веса прямо в образе файла
+    static bool parse(const char* data, const size_t size, const Tuple*& t, const int16_t*& w, size_t& count)
+    {
+        uint32_t header[4];
+        if (size < Header_size || memcmp(data, "CKNT", 4) != 0)
+            return false;
+        memcpy(header, data + 4, sizeof(header));
+        if (header[0] != Version || header[2] != Length || header[3] != States || header[1] == 0 ||
+            size != Header_size + header[1] * (sizeof(Tuple) + Entries * sizeof(int16_t)))
+            return false;
+        t = reinterpret_cast<const Tuple*>(data + Header_size);
+        for (uint32_t k = 0; k < header[1]; ++k)
+            for (auto sq : t[k])
+                if (sq >= Squares)
+                    return false;
+        count = header[1];
+        w = reinterpret_cast<const int16_t*>(t + count);
+        return true;
+    }
+
+    bool attach(const char* data, const size_t size)
+    {
+        return parse(data, size, tuples, w, tuple_count);
+    }
+
+    // Указывают в storage - отображение файла или его копию в памяти
+    const Tuple* tuples = nullptr;
+    const int16_t* w = nullptr;
+    size_t tuple_count = 0;
+    shared_ptr<const void> storage;
+    bool loaded = false;
+    uint64_t digest = 0;
+};
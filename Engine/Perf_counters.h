@@ -0,0 +1,192 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Аппаратные счётчики процессора для замеров поиска (Linux, perf_event_open): такты, инструкции,
+// промахи кэша последнего уровня и ошибки предсказания переходов. Считается только пользовательский
+// код этого потока и потоков, созданных после open (поток поиска окна, потоки MCTS).
+// Если счётчики недоступны (нет прав - kernel.perf_event_paranoid, виртуальная машина без PMU,
+// другая ОС), open возвращает false, а error() объясняет причину; замеры тогда просто не печатаются
+class Perf_counters
+{
+public:
+    enum Counter
+    {
+        Cycles,
+        Instructions,
+        Cache_misses,
+        Branch_misses,
+        Count
+    };
+
+    // Значения счётчиков за один замер (при мультиплексировании - оценка по доле времени работы)
+    struct Sample
+    {
+        uint64_t value[Count] = {};
+        bool valid[Count] = {};
+
+        double ipc() const
+        {
+            return valid[Cycles] && valid[Instructions] && value[Cycles] ? double(value[Instructions]) / value[Cycles]
+                                                                          : 0;
+        }
+
+        // Строка для лога: счётчики, IPC и стоимость одного узла (nodes <= 0 - без пересчёта на узел)
+        string format(const int64_t nodes) const
+        {
+            static const char* names[Count] = {"cycles", "instructions", "cache-misses", "branch-misses"};
+            string res;
+            char buf[96];
+            for (int k = 0; k < Count; ++k)
+            {
+                if (!valid[k])
+                    continue;
+                snprintf(buf, sizeof(buf), "%s%s %llu", res.empty() ? "" : ", ", names[k],
+                         (unsigned long long)value[k]);
+                res += buf;
+            }
+            if (res.empty())
+                return "no counters";
+            if (ipc() > 0)
+            {
+                snprintf(buf, sizeof(buf), ", IPC %.2f", ipc());
+                res += buf;
+            }
+            if (nodes > 0)
+            {
+                res += "; per node:";
+                for (int k = 0; k < Count; ++k)
+                {
+                    if (!valid[k])
+                        continue;
+                    snprintf(buf, sizeof(buf), " %.1f %s", double(value[k]) / nodes, names[k]);
+                    res += buf;
+                }
+            }
+            return res;
+        }
+    };
+
+    Perf_counters() = default;
+    Perf_counters(const Perf_counters&) = delete;
+    Perf_counters& operator=(const Perf_counters&) = delete;
+
+    ~Perf_counters()
+    {
+        close();
+    }
+
+    // Открытие счётчиков: true, если открылся хотя бы один
+    bool open()
+    {
+        close();
+#ifdef __linux__
+        static const uint64_t configs[Count] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        int first_errno = 0;
+        for (int k = 0; k < Count; ++k)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[k];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[k] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds[k] < 0 && !first_errno)
+                first_errno = errno;
+        }
+        if (is_open())
+            return true;
+        err = string("perf_event_open: ") + strerror(first_errno);
+        int paranoid = 0;
+        ifstream fin("/proc/sys/kernel/perf_event_paranoid");
+        if (fin >> paranoid)
+            err += " (kernel.perf_event_paranoid = " + to_string(paranoid) + ")";
+#else
+        err = "hardware counters are only supported on Linux";
+#endif
+        return false;
+    }
+
+    bool is_open() const
+    {
+        for (int fd : fds)
+            if (fd >= 0)
+                return true;
+        return false;
+    }
+
+    // Причина недоступности счётчиков
+    const string& error() const
+    {
+        return err;
+    }
+
+    // Начало замера: счётчики обнуляются и включаются
+    void start()
+    {
+#ifdef __linux__
+        for (int fd : fds)
+        {
+            if (fd < 0)
+                continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Конец замера
+    Sample stop()
+    {
+        Sample res;
+#ifdef __linux__
+        for (int k = 0; k < Count; ++k)
+        {
+            if (fds[k] < 0)
+                continue;
+            ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t data[3] = {}; // значение, время включения, время работы
+            if (read(fds[k], data, sizeof(data)) != ssize_t(sizeof(data)) || !data[2])
+                continue;
+            res.value[k] = data[2] < data[1] ? uint64_t(double(data[0]) * data[1] / data[2]) : data[0];
+            res.valid[k] = true;
+        }
+#endif
+        return res;
+    }
+
+    void close()
+    {
+#ifdef __linux__
+        for (int& fd : fds)
+        {
+            if (fd >= 0)
+                ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+
+private:
+    int fds[Count] = {-1, -1, -1, -1};
+    string err;
+};
@@ -0,0 +1,219 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Shared_memory.h"
+
+using namespace std;
+
+// Постоянный кэш результатов поиска в корне: файл, отображённый в память, переживает
+// перезапуски игры и процесса. Запись - ключ позиции, глубина, оценка и лучший ход (серия взятий).
+// Файл разбит на корзины по 4 записи; при нехватке места вытесняется запись с наименьшей
+// глубиной с поправкой на возраст (возраст - сколько раз кэш открывали после записи).
+// Каждая запись защищена контрольной суммой, которая пишется последней: запись, оборванная
+// падением процесса, при чтении считается пустой. Кэш работает только на платформах с mmap.
+class Position_cache
+{
+public:
+    static const int Min_depth = 4;  // более мелкие поиски не сохраняются
+    static const int Max_path = 12;  // клетка начала и до 11 клеток серии взятий
+    static const int Bucket_size = 4;
+
+    Position_cache() = default;
+    Position_cache(const Position_cache&) = delete;
+    Position_cache& operator=(const Position_cache&) = delete;
+
+    ~Position_cache()
+    {
+        close();
+    }
+
+    // Открытие или создание файла path размером не больше bytes.
+    // Файл другого размера или формата создаётся заново
+    bool open(const string& path, const size_t bytes)
+    {
+        close();
+#ifdef SHARED_MEMORY_POSIX
+        const size_t buckets = (bytes - min(bytes, sizeof(Header))) / (Bucket_size * sizeof(Record));
+        if (!buckets)
+            return false;
+        const size_t total = sizeof(Header) + buckets * Bucket_size * sizeof(Record);
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            return false;
+        struct stat st = {};
+        const bool fresh = fstat(fd, &st) != 0 || size_t(st.st_size) != total;
+        if (fresh && (ftruncate(fd, 0) != 0 || ftruncate(fd, off_t(total)) != 0))
+        {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        base = static_cast<char*>(p);
+        length = total;
+        header = reinterpret_cast<Header*>(base);
+        records = reinterpret_cast<Record*>(base + sizeof(Header));
+        bucket_count = buckets;
+        if (fresh || memcmp(header->magic, "CKPC", 4) != 0 || header->version != Version ||
+            header->buckets != buckets)
+        {
+            memset(base, 0, total);
+            memcpy(header->magic, "CKPC", 4);
+            header->version = Version;
+            header->buckets = buckets;
+        }
+        epoch = ++header->epoch;
+        return true;
+#else
+        (void)path;
+        (void)bytes;
+        return false;
+#endif
+    }
+
+    void close()
+    {
+#ifdef SHARED_MEMORY_POSIX
+        if (base)
+            munmap(base, length);
+#endif
+        base = nullptr;
+        header = nullptr;
+        records = nullptr;
+    }
+
+    bool is_open() const
+    {
+        return base != nullptr;
+    }
+
+    // Поиск записи не мельче depth: оценка и клетки хода (i * 4 + j / 2)
+    bool find(const uint64_t key, const int depth, int& found_depth, double& score, vector<uint8_t>& path) const
+    {
+        const Record* bucket = records + (key % bucket_count) * Bucket_size;
+        for (int k = 0; k < Bucket_size; ++k)
+        {
+            const Record r = bucket[k];
+            if (r.key != key || !valid(r) || r.depth < depth)
+                continue;
+            found_depth = r.depth;
+            score = r.score;
+            path.assign(r.path, r.path + r.length);
+            return true;
+        }
+        return false;
+    }
+
+    // Запись результата: та же позиция заменяется более глубоким поиском,
+    // иначе занимается пустая или самая малоценная запись корзины
+    void store(const uint64_t key, const int depth, const double score, const vector<uint8_t>& path)
+    {
+        if (depth < Min_depth || path.empty() || path.size() > Max_path)
+            return;
+        Record* bucket = records + (key % bucket_count) * Bucket_size;
+        Record* victim = nullptr;
+        int victim_value = 1 << 30;
+        for (int k = 0; k < Bucket_size; ++k)
+        {
+            Record& r = bucket[k];
+            if (!valid(r))
+            {
+                if (victim_value > -1)
+                {
+                    victim = &r;
+                    victim_value = -1;
+                }
+                continue;
+            }
+            if (r.key == key)
+            {
+                if (r.depth > depth)
+                    return;
+                victim = &r;
+                break;
+            }
+            const int value = r.depth * 4 - int(min<uint32_t>(uint16_t(epoch - r.age), 64));
+            if (value < victim_value)
+            {
+                victim = &r;
+                victim_value = value;
+            }
+        }
+        if (victim_value != -1 && victim->key != key && victim_value > depth * 4)
+            return; // все записи корзины глубже и свежее
+        Record r = {};
+        r.key = key;
+        r.score = score;
+        r.depth = uint8_t(depth);
+        r.length = uint8_t(path.size());
+        r.age = uint16_t(epoch);
+        memcpy(r.path, path.data(), path.size());
+        // сначала тело записи с нулевой суммой, сумма - последней
+        victim->checksum = 0;
+        atomic_signal_fence(memory_order_seq_cst);
+        memcpy(static_cast<void*>(victim), &r, offsetof(Record, checksum));
+        atomic_signal_fence(memory_order_seq_cst);
+        victim->checksum = checksum(r);
+    }
+
+    // Сброс изменённых страниц на диск (например, в конце партии)
+    void flush()
+    {
+#ifdef SHARED_MEMORY_POSIX
+        if (base)
+            msync(base, length, MS_ASYNC);
+#endif
+    }
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t buckets;
+        uint32_t epoch; // счётчик открытий файла
+        uint32_t reserved[9];
+    };
+
+    struct Record
+    {
+        uint64_t key;
+        double score;
+        uint8_t depth;
+        uint8_t length; // количество клеток в path
+        uint16_t age;   // epoch на момент записи
+        uint8_t path[Max_path];
+        uint32_t checksum; // 0 - пустая запись
+    };
+    static_assert(sizeof(Record) == 40, "Record is stored on disk");
+
+    static const uint32_t Version = 1;
+
+    static uint32_t checksum(const Record& r)
+    {
+        uint32_t h = 2166136261u;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&r);
+        for (size_t i = 0; i < offsetof(Record, checksum); ++i)
+            h = (h ^ p[i]) * 16777619u;
+        return h ? h : 1;
+    }
+
+    static bool valid(const Record& r)
+    {
+        return r.checksum && r.length && r.length <= Max_path && r.checksum == checksum(r);
+    }
+
+    char* base = nullptr;
+    size_t length = 0;
+    Header* header = nullptr;
+    Record* records = nullptr;
+    size_t bucket_count = 0;
+    uint32_t epoch = 0;
+};
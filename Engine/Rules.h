@@ -0,0 +1,396 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+using namespace std;
+
+// Правила вариантов шашек в виде политик для шаблонов генератора ходов и поиска.
+// Все различия - константы времени компиляции, поэтому в горячих циклах нет ветвлений по варианту.
+//   Size                    - сторона доски (8 или 10), тёмных полей Size * Size / 2
+//   Rows                    - количество рядов шашек в начальной расстановке
+//   Men_capture_backward    - простая шашка бьёт назад
+//   Flying_kings            - дамка ходит и бьёт на любое расстояние
+//   Majority_capture        - обязательно взятие наибольшего количества фигур
+//   Promote_mid_capture     - шашка, дошедшая до последнего ряда во время взятия, продолжает бить как дамка
+//   Capture_ends_on_promotion - взятие заканчивается превращением в дамку
+//   King_continuation_stop  - дамка обязана остановиться на поле, с которого взятие продолжается
+//   Remove_captured_at_once - снятая шашка сразу убирается с доски (иначе - в конце хода)
+//   King_value              - цена дамки в оценке (простая шашка - 100)
+struct Russian_rules
+{
+    static constexpr const char* Name = "russian";
+    static constexpr int Size = 8;
+    static constexpr int Rows = 3;
+    static constexpr bool Men_capture_backward = true;
+    static constexpr bool Flying_kings = true;
+    static constexpr bool Majority_capture = false;
+    static constexpr bool Promote_mid_capture = true;
+    static constexpr bool Capture_ends_on_promotion = false;
+    static constexpr bool King_continuation_stop = true;
+    static constexpr bool Remove_captured_at_once = false;
+    static constexpr int King_value = 300;
+};
+
+struct English_rules
+{
+    static constexpr const char* Name = "english";
+    static constexpr int Size = 8;
+    static constexpr int Rows = 3;
+    static constexpr bool Men_capture_backward = false;
+    static constexpr bool Flying_kings = false;
+    static constexpr bool Majority_capture = false;
+    static constexpr bool Promote_mid_capture = false;
+    static constexpr bool Capture_ends_on_promotion = true;
+    static constexpr bool King_continuation_stop = true;
+    static constexpr bool Remove_captured_at_once = false;
+    static constexpr int King_value = 150;
+};
+
+// Русские шашки в том виде, как их реализует Logic (игра в окне): дамка после взятия может
+// остановиться на любом свободном поле за снятой шашкой, снятые шашки сразу убираются с доски.
+// Нужны, чтобы решатель и игра рассматривали одни и те же ходы
+struct Logic_rules : Russian_rules
+{
+    static constexpr const char* Name = "russian-logic";
+    static constexpr bool King_continuation_stop = false;
+    static constexpr bool Remove_captured_at_once = true;
+};
+
+struct International_rules
+{
+    static constexpr const char* Name = "international";
+    static constexpr int Size = 10;
+    static constexpr int Rows = 4;
+    static constexpr bool Men_capture_backward = true;
+    static constexpr bool Flying_kings = true;
+    static constexpr bool Majority_capture = true;
+    static constexpr bool Promote_mid_capture = false;
+    static constexpr bool Capture_ends_on_promotion = false;
+    static constexpr bool King_continuation_stop = true;
+    static constexpr bool Remove_captured_at_once = false;
+    static constexpr int King_value = 300;
+};
+
+// Геометрия доски Size x Size: тёмные поля нумеруются с нуля построчно сверху вниз
+// (номер PDN - на единицу больше), на 8x8 это те же номера, что у Engine. Все поля
+// помещаются в 64-битную маску (32 для 8x8, 50 для 10x10)
+template <int Size> struct Geometry
+{
+    static constexpr int Squares = Size * Size / 2;
+    static constexpr int Row_squares = Size / 2;
+    static constexpr uint64_t All = (Squares == 64 ? ~0ULL : (1ULL << Squares) - 1);
+
+    // Направления: 0, 1 - вверх (вперёд для белых), 2, 3 - вниз (вперёд для черных)
+    static constexpr int Dir_row[4] = {-1, -1, 1, 1};
+    static constexpr int Dir_col[4] = {-1, 1, -1, 1};
+
+    static constexpr int row(const int sq)
+    {
+        return sq / Row_squares;
+    }
+
+    static constexpr int col(const int sq)
+    {
+        return 2 * (sq % Row_squares) + (row(sq) % 2 == 0 ? 1 : 0);
+    }
+
+    static constexpr int square(const int r, const int c)
+    {
+        return r * Row_squares + c / 2;
+    }
+
+    static constexpr uint64_t bit(const int sq)
+    {
+        return 1ULL << sq;
+    }
+
+    // Последний ряд для цвета: белые (false) идут к ряду 0, черные к ряду Size - 1
+    static constexpr bool promotion_row(const bool color, const int sq)
+    {
+        return row(sq) == (color ? Size - 1 : 0);
+    }
+
+    // Соседнее поле в направлении dir, -1 за краем доски
+    struct Tables
+    {
+        int8_t next[4][Squares];
+
+        constexpr Tables() : next()
+        {
+            for (int d = 0; d < 4; ++d)
+            {
+                for (int sq = 0; sq < Squares; ++sq)
+                {
+                    const int r = row(sq) + Dir_row[d], c = col(sq) + Dir_col[d];
+                    next[d][sq] = int8_t((r < 0 || r >= Size || c < 0 || c >= Size) ? -1 : square(r, c));
+                }
+            }
+        }
+    };
+
+    static constexpr Tables tables = Tables();
+
+    static constexpr int next(const int dir, const int sq)
+    {
+        return tables.next[dir][sq];
+    }
+};
+
+// Позиция варианта: маски фигур и цвет ходящего
+struct Variant_position
+{
+    uint64_t white = 0, black = 0, kings = 0;
+    bool color = false; // false - ходят белые
+};
+
+// Полный ход (серия взятий - одним ходом): поле начала, поля остановок и снятые фигуры
+struct Variant_move
+{
+    static const int Max_path = 24;
+
+    uint64_t captured = 0;
+    uint8_t from = 0;
+    uint8_t length = 0;       // количество полей в path, последнее - поле окончания хода
+    bool promote = false;     // шашка становится дамкой
+    uint8_t path[Max_path] = {};
+
+    int to() const
+    {
+        return path[length - 1];
+    }
+};
+
+// Список ходов фиксированной ёмкости без выделений памяти
+struct Move_list
+{
+    static const int Capacity = 256;
+
+    Variant_move moves[Capacity];
+    int size = 0;
+
+    // Ёмкости хватает на все различные ходы позиции: взятия приходят уже без коротких серий
+    // и повторов (Move_generator::add_capture)
+    void push(const Variant_move& m)
+    {
+        assert(size < Capacity);
+        if (size < Capacity)
+            moves[size++] = m;
+    }
+};
+
+// Генератор ходов, специализированный правилами варианта
+template <class Rules> class Move_generator
+{
+public:
+    using G = Geometry<Rules::Size>;
+
+    // Все допустимые ходы: при наличии взятия - только взятия (с правилом большинства, если оно есть)
+    static void generate(const Variant_position& pos, Move_list& list)
+    {
+        list.size = 0;
+        Context c;
+        c.own = pos.color ? pos.black : pos.white;
+        c.opp = pos.color ? pos.white : pos.black;
+        c.color = pos.color;
+        for (uint64_t pieces = c.own; pieces; pieces &= pieces - 1)
+        {
+            const int sq = lowest(pieces);
+            c.empty = ~(c.own | c.opp) & G::All;
+            c.empty |= G::bit(sq); // фигура покидает начальное поле
+            Variant_move m;
+            m.from = uint8_t(sq);
+            captures(c, sq, (pos.kings & G::bit(sq)) != 0, false, m, list);
+        }
+        if (list.size)
+            return;
+        c.empty = ~(c.own | c.opp) & G::All;
+        for (uint64_t pieces = c.own; pieces; pieces &= pieces - 1)
+        {
+            const int sq = lowest(pieces);
+            const bool king = (pos.kings & G::bit(sq)) != 0;
+            for (int d = 0; d < 4; ++d)
+            {
+                if (!king && !forward(pos.color, d))
+                    continue;
+                for (int to = G::next(d, sq); to != -1 && (c.empty & G::bit(to)); to = G::next(d, to))
+                {
+                    Variant_move m;
+                    m.from = uint8_t(sq);
+                    m.length = 1;
+                    m.path[0] = uint8_t(to);
+                    m.promote = !king && G::promotion_row(pos.color, to);
+                    list.push(m);
+                    if (!king || !Rules::Flying_kings)
+                        break;
+                }
+            }
+        }
+    }
+
+    // Позиция после хода
+    static Variant_position apply(Variant_position pos, const Variant_move& m)
+    {
+        const uint64_t from = G::bit(m.from), to = G::bit(m.to());
+        uint64_t& own = pos.color ? pos.black : pos.white;
+        uint64_t& opp = pos.color ? pos.white : pos.black;
+        // дамка может закончить серию взятий на поле начала
+        own = (own & ~from) | to;
+        opp &= ~m.captured;
+        pos.kings &= ~m.captured;
+        if (pos.kings & from)
+            pos.kings = (pos.kings & ~from) | to;
+        else if (m.promote)
+            pos.kings |= to;
+        pos.color = !pos.color;
+        return pos;
+    }
+
+    static int lowest(const uint64_t mask)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(mask);
+#else
+        int res = 0;
+        while (!((mask >> res) & 1))
+            ++res;
+        return res;
+#endif
+    }
+
+private:
+    struct Context
+    {
+        uint64_t own = 0, opp = 0, empty = 0;
+        bool color = false;
+    };
+
+    static constexpr bool forward(const bool color, const int dir)
+    {
+        return color ? dir >= 2 : dir < 2;
+    }
+
+    // Фигуру на поле sq, взятую в серии, можно бить: соперник, ещё не снятый в этой серии
+    // (снятые фигуры остаются на доске до конца хода и преграждают путь)
+    static bool can_jump(const Context& c, const uint64_t captured, const int sq)
+    {
+        return sq != -1 && (c.opp & G::bit(sq)) && !(captured & G::bit(sq));
+    }
+
+    // Есть ли продолжение взятия с поля sq
+    static bool has_capture(const Context& c, const int sq, const bool king, const uint64_t captured)
+    {
+        for (int d = 0; d < 4; ++d)
+        {
+            if (!king && !Rules::Men_capture_backward && !forward(c.color, d))
+                continue;
+            int s = G::next(d, sq);
+            if (king && Rules::Flying_kings)
+                while (s != -1 && (c.empty & G::bit(s)))
+                    s = G::next(d, s);
+            if (!can_jump(c, captured, s))
+                continue;
+            const int land = G::next(d, s);
+            if (land != -1 && (c.empty & G::bit(land)))
+                return true;
+        }
+        return false;
+    }
+
+    // Поиск в глубину всех серий взятий фигуры, стоящей на sq
+    static void captures(const Context& c, const int sq, const bool king, const bool promoted, Variant_move& m,
+                         Move_list& list)
+    {
+        bool found = false;
+        for (int d = 0; d < 4; ++d)
+        {
+            if (!king && !Rules::Men_capture_backward && !forward(c.color, d))
+                continue;
+            int s = G::next(d, sq);
+            if (king && Rules::Flying_kings)
+                while (s != -1 && (c.empty & G::bit(s)))
+                    s = G::next(d, s);
+            if (!can_jump(c, m.captured, s))
+                continue;
+            int lands[Rules::Size];
+            int count = 0;
+            for (int land = G::next(d, s); land != -1 && (c.empty & G::bit(land)); land = G::next(d, land))
+            {
+                lands[count++] = land;
+                if (!king || !Rules::Flying_kings)
+                    break;
+            }
+            if (!count || m.length == Variant_move::Max_path)
+                continue;
+            found = true;
+            m.captured |= G::bit(s);
+            Context next = c;
+            if (Rules::Remove_captured_at_once)
+                next.empty |= G::bit(s);
+            // дамка обязана остановиться на поле, с которого взятие продолжается, если такое есть
+            bool any_continue = false;
+            if (Rules::King_continuation_stop && count > 1)
+                for (int k = 0; k < count && !any_continue; ++k)
+                    any_continue = has_capture(next, lands[k], king, m.captured);
+            for (int k = 0; k < count; ++k)
+            {
+                if (any_continue && !has_capture(next, lands[k], king, m.captured))
+                    continue;
+                m.path[m.length++] = uint8_t(lands[k]);
+                const bool reached = !king && G::promotion_row(c.color, lands[k]);
+                if (reached && Rules::Capture_ends_on_promotion)
+                {
+                    m.promote = true;
+                    add_capture(m, list);
+                    m.promote = false;
+                }
+                else if (reached && Rules::Promote_mid_capture)
+                    captures(next, lands[k], true, true, m, list);
+                else
+                    captures(next, lands[k], king, promoted, m, list);
+                --m.length;
+            }
+            m.captured &= ~G::bit(s);
+        }
+        if (!found && m.length)
+        {
+            m.promote = promoted || (!king && G::promotion_row(c.color, m.to()));
+            add_capture(m, list);
+            m.promote = false;
+        }
+    }
+
+    // Законченная серия взятий в список. Правило большинства применяется сразу: более длинная серия
+    // вытесняет короткие. Разные пути с теми же началом, концом и снятыми фигурами - один ход.
+    // Так в списке не копятся короткие серии и повторы путей дамки, которые переполняли его ёмкость
+    static void add_capture(const Variant_move& m, Move_list& list)
+    {
+        if constexpr (Rules::Majority_capture)
+        {
+            if (list.size)
+            {
+                const int n = popcount(m.captured), best = popcount(list.moves[0].captured);
+                if (n < best)
+                    return;
+                if (n > best)
+                    list.size = 0;
+            }
+        }
+        for (int t = 0; t < list.size; ++t)
+            if (list.moves[t].from == m.from && list.moves[t].to() == m.to() && list.moves[t].captured == m.captured)
+                return;
+        list.push(m);
+    }
+
+    static int popcount(uint64_t mask)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(mask);
+#else
+        int res = 0;
+        for (; mask; mask &= mask - 1)
+            ++res;
+        return res;
+#endif
+    }
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// Ход текущего поиска для отображения в окне. Пишет только поток поиска, читает поток окна.
+// Блокировок нет: счётчики атомарные, лучший ход и оценка защищены счётчиком версий (seqlock) -
+// читатель повторяет чтение, если во время него была запись. Поиск обновляет узлы раз в 4096 узлов,
+// лучший ход - по мере перебора ходов в корне, поэтому частота записей ограничена
+class Search_stats
+{
+public:
+    static const int Max_path = 14; // клетка начала и до 13 клеток серии взятий
+
+    struct Snapshot
+    {
+        bool active = false;    // поиск идёт
+        int depth = 0;          // глубина поиска
+        int64_t nodes = 0;
+        int64_t elapsed_ms = 0;
+        bool has_best = false;
+        bool capture = false;   // лучший ход - взятие
+        vector<uint8_t> path;   // клетки лучшего хода (i * 4 + j / 2)
+        double score = 0;       // оценка бота в шкале calc_score
+    };
+
+    // Начало поиска на глубину depth
+    void begin(const int depth)
+    {
+        write_best(vector<move_pos>(), 0);
+        search_depth.store(depth, memory_order_relaxed);
+        node_count.store(0, memory_order_relaxed);
+        start_ns.store(now_ns(), memory_order_relaxed);
+        end_ns.store(0, memory_order_relaxed);
+        running.store(true, memory_order_release);
+    }
+
+    void set_nodes(const int64_t nodes)
+    {
+        node_count.store(nodes, memory_order_relaxed);
+    }
+
+    // Новый лучший ход в корне
+    void set_best(const vector<move_pos>& turn, const double score)
+    {
+        write_best(turn, score);
+    }
+
+    void end()
+    {
+        end_ns.store(now_ns(), memory_order_relaxed);
+        running.store(false, memory_order_release);
+    }
+
+    Snapshot read() const
+    {
+        Snapshot s;
+        s.active = running.load(memory_order_acquire);
+        s.depth = search_depth.load(memory_order_relaxed);
+        s.nodes = node_count.load(memory_order_relaxed);
+        const int64_t finish = s.active ? 0 : end_ns.load(memory_order_relaxed);
+        s.elapsed_ms = ((finish ? finish : now_ns()) - start_ns.load(memory_order_relaxed)) / 1000000;
+        uint64_t w0, w1, bits;
+        uint32_t v1, v2;
+        do
+        {
+            v1 = version.load(memory_order_acquire);
+            w0 = words[0].load(memory_order_relaxed);
+            w1 = words[1].load(memory_order_relaxed);
+            bits = score_bits.load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            v2 = version.load(memory_order_relaxed);
+        } while ((v1 & 1) || v1 != v2);
+        uint8_t bytes[16];
+        memcpy(bytes, &w0, 8);
+        memcpy(bytes + 8, &w1, 8);
+        for (int k = 0; k < Max_path && bytes[k]; ++k)
+            s.path.push_back(uint8_t(bytes[k] - 1));
+        s.capture = bytes[15] != 0;
+        s.has_best = !s.path.empty();
+        memcpy(&s.score, &bits, 8);
+        return s;
+    }
+
+private:
+    static int64_t now_ns()
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Клетки хода по байту (номер + 1, 0 - конец), последний байт - признак взятия
+    void write_best(const vector<move_pos>& turn, const double score)
+    {
+        uint8_t bytes[16] = {};
+        if (!turn.empty())
+        {
+            bytes[0] = uint8_t(turn[0].x * 4 + turn[0].y / 2 + 1);
+            for (size_t k = 0; k < turn.size() && k + 1 < Max_path; ++k)
+                bytes[k + 1] = uint8_t(turn[k].x2 * 4 + turn[k].y2 / 2 + 1);
+            bytes[15] = turn[0].xb != -1;
+        }
+        uint64_t w0, w1, bits;
+        memcpy(&w0, bytes, 8);
+        memcpy(&w1, bytes + 8, 8);
+        memcpy(&bits, &score, 8);
+        const uint32_t v = version.load(memory_order_relaxed);
+        version.store(v + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        words[0].store(w0, memory_order_relaxed);
+        words[1].store(w1, memory_order_relaxed);
+        score_bits.store(bits, memory_order_relaxed);
+        version.store(v + 2, memory_order_release);
+    }
+
+    atomic<bool> running{false};
+    atomic<int> search_depth{0};
+    atomic<int64_t> node_count{0};
+    atomic<int64_t> start_ns{0};
+    atomic<int64_t> end_ns{0}; // 0 - поиск идёт
+    atomic<uint32_t> version{0};
+    atomic<uint64_t> words[2] = {};
+    atomic<uint64_t> score_bits{0};
+};
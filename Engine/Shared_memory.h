@@ -0,0 +1,226 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHARED_MEMORY_POSIX
+#endif
+
+using namespace std;
+
+// Именованный сегмент общей памяти POSIX (shm_open + mmap) для данных, общих у всех процессов движка
+// на одной машине. Первый процесс создаёт сегмент и заполняет его, остальные ждут готовности
+// и подключаются к тем же страницам. Сегмент живёт до remove() или перезагрузки машины.
+// На платформах без POSIX open() возвращает false, и вызывающий использует обычную память.
+class Shared_memory
+{
+public:
+    Shared_memory() = default;
+    Shared_memory(const Shared_memory&) = delete;
+    Shared_memory& operator=(const Shared_memory&) = delete;
+
+    ~Shared_memory()
+    {
+        close();
+    }
+
+    // Подключение к сегменту name с size байтами данных. Создатель заполняет данные функцией init
+    // (false - ошибка, сегмент удаляется). writable = false - данные только для чтения у всех процессов
+    bool open(const string& name, const size_t size, const function<bool(char*)>& init = nullptr,
+              const bool writable = true)
+    {
+        close();
+#ifdef SHARED_MEMORY_POSIX
+        const size_t total = sizeof(Header) + size;
+        created = false;
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0)
+        {
+            created = true;
+            if (ftruncate(fd, off_t(total)) != 0)
+            {
+                ::close(fd);
+                shm_unlink(name.c_str());
+                return false;
+            }
+        }
+        else if (errno == EEXIST)
+        {
+            fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+            // создатель мог ещё не задать размер
+            struct stat st = {};
+            for (int k = 0; fd >= 0 && k < 1000 && fstat(fd, &st) == 0 && size_t(st.st_size) < total; ++k)
+                this_thread::sleep_for(chrono::milliseconds(1));
+            if (fd >= 0 && size_t(st.st_size) != total)
+            {
+                ::close(fd);
+                return false;
+            }
+        }
+        if (fd < 0)
+            return false;
+        const int prot = (created || writable) ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* p = mmap(nullptr, total, prot, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        base = static_cast<char*>(p);
+        length = total;
+        Header* header = reinterpret_cast<Header*>(base);
+        if (created)
+        {
+            header->size = size;
+            const bool ok = !init || init(base + sizeof(Header));
+            header->state.store(ok ? Ready : Failed, memory_order_release);
+            if (!ok)
+            {
+                shm_unlink(name.c_str());
+                close();
+                return false;
+            }
+            if (!writable)
+                mprotect(base, total, PROT_READ);
+        }
+        else
+        {
+            // упавший во время заполнения создатель оставит сегмент неготовым - ждём не больше 10 с
+            for (int k = 0; k < 10000 && header->state.load(memory_order_acquire) == Initializing; ++k)
+                this_thread::sleep_for(chrono::milliseconds(1));
+            if (header->state.load(memory_order_acquire) != Ready || header->size != size)
+            {
+                close();
+                return false;
+            }
+        }
+        return true;
+#else
+        (void)name;
+        (void)size;
+        (void)init;
+        (void)writable;
+        return false;
+#endif
+    }
+
+    void close()
+    {
+#ifdef SHARED_MEMORY_POSIX
+        if (base)
+            munmap(base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    // Удаление имени сегмента (подключённые процессы продолжают работать со своими отображениями)
+    static bool remove(const string& name)
+    {
+#ifdef SHARED_MEMORY_POSIX
+        return shm_unlink(name.c_str()) == 0;
+#else
+        (void)name;
+        return false;
+#endif
+    }
+
+    bool is_open() const
+    {
+        return base != nullptr;
+    }
+
+    // Создан ли сегмент этим процессом
+    bool is_creator() const
+    {
+        return created;
+    }
+
+    char* data() const
+    {
+        return base ? base + sizeof(Header) : nullptr;
+    }
+
+    size_t size() const
+    {
+        return base ? length - sizeof(Header) : 0;
+    }
+
+private:
+    enum State : uint32_t
+    {
+        Initializing,
+        Ready,
+        Failed
+    };
+
+    // Заголовок в начале сегмента, данные выровнены на 64 байта
+    struct alignas(64) Header
+    {
+        atomic<uint32_t> state;
+        uint64_t size;
+    };
+
+    char* base = nullptr;
+    size_t length = 0;
+    bool created = false;
+};
+
+// Файл, отображённый в память только для чтения (без POSIX open() возвращает false)
+struct Mapped_file
+{
+    const char* base = nullptr;
+    size_t length = 0;
+
+    bool open(const string& path)
+    {
+        close();
+#ifdef SHARED_MEMORY_POSIX
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st = {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        base = static_cast<const char*>(p);
+        length = size_t(st.st_size);
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    void close()
+    {
+#ifdef SHARED_MEMORY_POSIX
+        if (base)
+            munmap(const_cast<char*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+};
+
+// Хеш FNV-1a содержимого файла весов: имя сегмента общей памяти сети и часть ключа кэша позиций
+inline uint64_t content_hash(const char* data, const size_t size)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t k = 0; k < size; ++k)
+        h = (h ^ uint8_t(data[k])) * 1099511628211ULL;
+    return h;
+}
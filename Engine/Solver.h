@@ -0,0 +1,290 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Rules.h"
+
+using namespace std;
+
+// Итог решения позиции с точки зрения ходящего
+enum class Solve_status
+{
+    Win,     // форсированный выигрыш в пределах лимита полуходов
+    Loss,    // форсированный проигрыш
+    Draw,    // ни одна сторона не выигрывает в пределах лимита (в игре - ничья по лимиту ходов)
+    Unknown  // исчерпан бюджет узлов или времени
+};
+
+struct Solve_result
+{
+    Solve_status status = Solve_status::Unknown;
+    vector<Variant_move> line; // выигрывающий вариант (для Win и Loss), первый ход - ход ходящего
+    int length = 0;            // полуходов до конца партии при лучшей защите
+    int64_t nodes = 0;
+    int64_t time_ms = 0;
+};
+
+// Решатель форсированных выигрышей: поиск по числам доказательства в глубину (df-pn) с порогом 1 + 1/4.
+// Доказывается, что атакующая сторона выигрывает не позже чем через max_plies полуходов; позиция
+// на пределе считается невыигранной атакующим. Win/Loss/Draw - два доказательства (за ходящего
+// и за соперника). Таблица перестановок ограничена по памяти: при нехватке места вытесняется запись
+// с меньшей проделанной работой. Ключ записи включает остаток полуходов: остаток убывает вдоль
+// любого пути, поэтому повторения позиций (ходы дамками) не образуют циклов в графе перебора
+template <class Rules> class Proof_solver
+{
+public:
+    using Gen = Move_generator<Rules>;
+
+    static const uint32_t Infinity = 1u << 30;
+    static const int Max_plies = 256; // глубина рекурсии ограничена стеком
+
+    explicit Proof_solver(const size_t bytes = size_t(64) << 20)
+    {
+        resize(bytes);
+    }
+
+    void resize(const size_t bytes)
+    {
+        size_t count = 2;
+        while (count * 2 * sizeof(Entry) <= bytes)
+            count *= 2;
+        table.assign(count, Entry());
+    }
+
+    void clear()
+    {
+        fill(table.begin(), table.end(), Entry());
+    }
+
+    // Остановка из другого потока
+    void stop()
+    {
+        stop_flag = true;
+    }
+
+    // Решение позиции: max_plies - лимит полуходов, node_limit и time_ms - бюджет (0 - без ограничения)
+    Solve_result solve(const Variant_position& pos, const int max_plies, const int64_t node_limit = 0,
+                       const int64_t time_ms = 0)
+    {
+        const auto start = chrono::steady_clock::now();
+        stop_flag = false;
+        max_nodes = node_limit;
+        deadline = time_ms ? start + chrono::milliseconds(time_ms) : chrono::steady_clock::time_point::max();
+        nodes = 0;
+        Solve_result res;
+        const int plies = max(0, min(max_plies, Max_plies));
+        const int win = prove(pos, pos.color, plies);
+        const int loss = win == 1 ? 0 : prove(pos, !pos.color, plies);
+        if (win == 1 || loss == 1)
+        {
+            res.status = win == 1 ? Solve_status::Win : Solve_status::Loss;
+            attacker = win == 1 ? pos.color : !pos.color;
+            extract_line(pos, plies, res);
+        }
+        else if (win == 0 && loss == 0)
+            res.status = Solve_status::Draw;
+        res.nodes = nodes;
+        res.time_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        return res;
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t key = 0;
+        uint32_t phi = 0, delta = 0; // 0/0 - пустая запись
+        uint32_t work = 0;           // узлов в поддереве (приоритет при вытеснении)
+        uint32_t length = 0;         // длина выигрыша атакующего
+    };
+
+    // Числа узла в форме phi/delta: phi - доказательство того, что ходящий добивается своей цели
+    // (атакующий - выигрыша, защищающийся - отсутствия проигрыша), delta - опровержение
+    struct Numbers
+    {
+        uint32_t phi = 1, delta = 1;
+        int length = 0;
+    };
+
+    // 1 - атакующий выигрывает, 0 - не выигрывает, -1 - бюджет исчерпан
+    int prove(const Variant_position& pos, const bool attacker_color, const int plies)
+    {
+        attacker = attacker_color;
+        aborted = false;
+        const bool attacker_moves = pos.color == attacker;
+        mid(pos, Infinity - 1, Infinity - 1, plies);
+        const Numbers n = lookup(pos, plies);
+        if (n.phi == 0)
+            return attacker_moves ? 1 : 0;
+        if (n.delta == 0)
+            return attacker_moves ? 0 : 1;
+        return -1;
+    }
+
+    static uint64_t mix(uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t key(const Variant_position& pos, const int remaining) const
+    {
+        return mix(pos.white ^ mix(pos.black ^ mix(pos.kings ^ (uint64_t(remaining) << 1 | (pos.color ? 1 : 0)) ^
+                                                   (attacker ? 0xA5A5A5A500000000ULL : 0))));
+    }
+
+    Entry* find(const uint64_t k)
+    {
+        Entry* e = &table[(k & (table.size() - 1)) & ~size_t(1)];
+        if (e[0].key == k && (e[0].phi || e[0].delta))
+            return e;
+        if (e[1].key == k && (e[1].phi || e[1].delta))
+            return e + 1;
+        return nullptr;
+    }
+
+    Numbers lookup(const Variant_position& pos, const int remaining)
+    {
+        Numbers n;
+        if (const Entry* e = find(key(pos, remaining)))
+        {
+            n.phi = e->phi;
+            n.delta = e->delta;
+            n.length = int(e->length);
+        }
+        return n;
+    }
+
+    void store(const Variant_position& pos, const Numbers& n, const int remaining, const uint64_t work)
+    {
+        const uint64_t k = key(pos, remaining);
+        Entry* e = find(k);
+        if (!e)
+        {
+            Entry* bucket = &table[(k & (table.size() - 1)) & ~size_t(1)];
+            e = bucket[0].work <= bucket[1].work ? bucket : bucket + 1;
+        }
+        e->key = k;
+        e->phi = n.phi;
+        e->delta = n.delta;
+        e->work = uint32_t(min<uint64_t>(work, UINT32_MAX));
+        e->length = uint32_t(n.length);
+    }
+
+    bool should_stop()
+    {
+        if (!aborted && (stop_flag.load(memory_order_relaxed) || (max_nodes && nodes >= max_nodes) ||
+                         ((nodes & 1023) == 0 && chrono::steady_clock::now() >= deadline)))
+            aborted = true;
+        return aborted;
+    }
+
+    static uint32_t add(const uint32_t a, const uint32_t b)
+    {
+        return uint32_t(min<uint64_t>(uint64_t(a) + b, Infinity));
+    }
+
+    // Развёртывание узла, пока его числа не превысят пороги
+    void mid(const Variant_position& pos, const uint32_t th_phi, const uint32_t th_delta, const int remaining)
+    {
+        const int64_t start_nodes = nodes++;
+        Move_list list;
+        Gen::generate(pos, list);
+        Numbers n;
+        if (!list.size)
+        {
+            // ходящий проиграл
+            n.phi = Infinity;
+            n.delta = 0;
+            store(pos, n, remaining, 1);
+            return;
+        }
+        if (remaining == 0)
+        {
+            // предел: атакующий не успел выиграть
+            const bool attacker_moves = pos.color == attacker;
+            n.phi = attacker_moves ? Infinity : 0;
+            n.delta = attacker_moves ? 0 : Infinity;
+            store(pos, n, remaining, 1);
+            return;
+        }
+        vector<Variant_position> children(list.size);
+        for (int k = 0; k < list.size; ++k)
+            children[k] = Gen::apply(pos, list.moves[k]);
+        while (true)
+        {
+            // phi = min delta детей, delta = сумма phi детей
+            n.phi = Infinity;
+            n.delta = 0;
+            uint32_t delta2 = Infinity;
+            int best = 0, win_length = INT32_MAX, hold_length = 0;
+            for (int k = 0; k < list.size; ++k)
+            {
+                const Numbers c = lookup(children[k], remaining - 1);
+                if (c.delta < n.phi)
+                {
+                    delta2 = n.phi;
+                    n.phi = c.delta;
+                    best = k;
+                }
+                else if (c.delta < delta2)
+                    delta2 = c.delta;
+                n.delta = add(n.delta, c.phi);
+                if (c.delta == 0)
+                    win_length = min(win_length, c.length);
+                hold_length = max(hold_length, c.length);
+            }
+            // длина выигрыша: кратчайший выигрывающий ход атакующего, самая упорная защита
+            n.length = 1 + (n.phi == 0 ? win_length : hold_length);
+            if (n.phi >= th_phi || n.delta >= th_delta || should_stop())
+            {
+                store(pos, n, remaining, uint64_t(nodes - start_nodes));
+                return;
+            }
+            const Numbers c = lookup(children[best], remaining - 1);
+            const uint32_t child_th_phi = th_delta - (n.delta - c.phi);
+            const uint32_t child_th_delta = min<uint64_t>(th_phi, max<uint64_t>(delta2 + 1, uint64_t(delta2) * 5 / 4));
+            mid(children[best], child_th_phi, child_th_delta, remaining - 1);
+        }
+    }
+
+    // Вариант по доказательству: атакующий выбирает кратчайший выигрыш, защищающийся - самую долгую защиту
+    void extract_line(Variant_position pos, int remaining, Solve_result& res)
+    {
+        res.length = lookup(pos, remaining).length;
+        while (remaining > 0)
+        {
+            Move_list list;
+            Gen::generate(pos, list);
+            int best = -1, best_length = 0;
+            for (int k = 0; k < list.size; ++k)
+            {
+                const Numbers c = lookup(Gen::apply(pos, list.moves[k]), remaining - 1);
+                const bool child_attacker_wins = (pos.color == attacker) ? c.delta == 0 : c.phi == 0;
+                if (!child_attacker_wins)
+                    continue;
+                if (best == -1 || (pos.color == attacker ? c.length < best_length : c.length > best_length))
+                {
+                    best = k;
+                    best_length = c.length;
+                }
+            }
+            if (best == -1)
+                break;
+            res.line.push_back(list.moves[best]);
+            pos = Gen::apply(pos, list.moves[best]);
+            --remaining;
+        }
+    }
+
+    vector<Entry> table;
+    bool attacker = false; // цвет атакующей стороны текущего доказательства
+    atomic<bool> stop_flag{false};
+    bool aborted = false;
+    int64_t nodes = 0;
+    int64_t max_nodes = 0;
+    chrono::steady_clock::time_point deadline;
+};
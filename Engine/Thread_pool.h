@@ -0,0 +1,149 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Пул потоков с очередью на каждый поток и кражей задач.
+// Задача, поставленная из рабочего потока, попадает в его очередь, остальные - по кругу.
+// Поток берёт задачи из начала своей очереди (по порядку поступления), а без работы
+// забирает задачи с конца чужих очередей
+class Thread_pool
+{
+public:
+    explicit Thread_pool(size_t threads = 0)
+    {
+        if (!threads)
+            threads = max(1u, thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; ++i)
+            queues.push_back(make_unique<Queue>());
+        for (size_t i = 0; i < threads; ++i)
+            workers.emplace_back([this, i]() { work(i); });
+    }
+
+    ~Thread_pool()
+    {
+        wait_idle();
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers)
+            w.join();
+    }
+
+    Thread_pool(const Thread_pool&) = delete;
+    Thread_pool& operator=(const Thread_pool&) = delete;
+
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+    void submit(function<void()> task)
+    {
+        size_t i = (current_pool == this) ? current_index : next_queue++ % queues.size();
+        {
+            lock_guard<mutex> lock(queues[i]->m);
+            queues[i]->tasks.push_back(move(task));
+        }
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            ++pending;
+            ++queued;
+        }
+        wake.notify_one();
+    }
+
+    // Ожидание выполнения всех поставленных задач
+    void wait_idle()
+    {
+        unique_lock<mutex> lock(wake_mutex);
+        idle.wait(lock, [this]() { return pending == 0; });
+    }
+
+    // Количество задач, украденных из чужих очередей
+    uint64_t steals() const
+    {
+        return stolen;
+    }
+
+private:
+    struct Queue
+    {
+        mutex m;
+        deque<function<void()>> tasks;
+    };
+
+    bool pop(const size_t i, function<void()>& task)
+    {
+        lock_guard<mutex> lock(queues[i]->m);
+        if (queues[i]->tasks.empty())
+            return false;
+        task = move(queues[i]->tasks.front());
+        queues[i]->tasks.pop_front();
+        --queued;
+        return true;
+    }
+
+    bool steal(const size_t i, function<void()>& task)
+    {
+        for (size_t k = 1; k < queues.size(); ++k)
+        {
+            Queue& q = *queues[(i + k) % queues.size()];
+            lock_guard<mutex> lock(q.m);
+            if (q.tasks.empty())
+                continue;
+            task = move(q.tasks.back());
+            q.tasks.pop_back();
+            --queued;
+            ++stolen;
+            return true;
+        }
+        return false;
+    }
+
+    void work(const size_t i)
+    {
+        current_pool = this;
+        current_index = i;
+        function<void()> task;
+        while (true)
+        {
+            if (pop(i, task) || steal(i, task))
+            {
+                task();
+                task = nullptr;
+                lock_guard<mutex> lock(wake_mutex);
+                if (--pending == 0)
+                    idle.notify_all();
+                continue;
+            }
+            unique_lock<mutex> lock(wake_mutex);
+            wake.wait(lock, [this]() { return stopping || queued > 0; });
+            if (stopping)
+                return;
+        }
+    }
+
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> workers;
+    mutex wake_mutex;
+    condition_variable wake, idle;
+    size_t pending = 0;           // поставленные и ещё не завершённые задачи
+    atomic<int64_t> queued{0};    // задачи в очередях (увеличивается под wake_mutex)
+    bool stopping = false;
+    atomic<size_t> next_queue{0};
+    atomic<uint64_t> stolen{0};
+
+    static inline thread_local Thread_pool* current_pool = nullptr;
+    static inline thread_local size_t current_index = 0;
+};
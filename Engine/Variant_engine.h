@@ -0,0 +1,418 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Engine.h"
+#include "Rules.h"
+
+// Результат поиска варианта: ход в записи PDN ("32-28", "28x19x10") и оценка
+// в сотых долях простой шашки с точки зрения ходящего
+struct Variant_result
+{
+    string move;
+    int score = 0;
+    int depth = -1;
+    int64_t nodes = 0;
+    int64_t time_ms = 0;
+    string pv; // главная вариация: ходы через пробел, первый - move
+};
+
+// Оценка выигрыша (уменьшается на номер полухода, чтобы выбирался кратчайший выигрыш)
+const int Variant_win = 100000;
+
+// Движок варианта правил. Виртуальны только вызовы интерфейса, генерация ходов
+// и перебор внутри специализированы правилами при компиляции
+class Variant_engine_base
+{
+public:
+    virtual ~Variant_engine_base() = default;
+
+    virtual string name() const = 0;
+    virtual void set_start_position() = 0;
+    // FEN как у Engine, клетки 1..Size * Size / 2
+    virtual bool set_position(const string& fen) = 0;
+    virtual string position() const = 0;
+    virtual vector<string> legal_moves() const = 0;
+    // Полная запись хода или сокращённая "начало x конец", если она однозначна
+    virtual bool play(const string& move) = 0;
+    virtual Variant_result search(const Search_limits& limits,
+                                  const function<void(const Variant_result&)>& on_depth = nullptr) = 0;
+    // Остановка держится до clear_stop() (как у Engine), сбрасывается до запуска поиска
+    virtual void stop() = 0;
+    virtual void clear_stop() = 0;
+    // Количество позиций на глубине depth (проверка генератора ходов)
+    virtual uint64_t perft(int depth) const = 0;
+};
+
+// Альфа-бета перебор (negamax) с итеративным углублением для правил Rules
+template <class Rules> class Variant_search
+{
+public:
+    using Gen = Move_generator<Rules>;
+    using G = Geometry<Rules::Size>;
+
+    static const int Max_ply = 64;
+
+    void set_limits(const atomic<bool>* stop, const int64_t node_limit, const chrono::steady_clock::time_point deadline)
+    {
+        stop_flag = stop;
+        max_nodes = node_limit;
+        stop_time = deadline;
+        nodes = 0;
+        aborted = false;
+    }
+
+    // Поиск на глубину depth; лучший ход прошлой итерации (best) перебирается первым
+    int search_root(const Variant_position& pos, const int depth, Variant_move& best)
+    {
+        Move_list list;
+        Gen::generate(pos, list);
+        if (!list.size)
+            return -Variant_win;
+        for (int k = 1; k < list.size; ++k)
+        {
+            if (same(list.moves[k], best))
+            {
+                swap(list.moves[0], list.moves[k]);
+                break;
+            }
+        }
+        int alpha = -Variant_win - 1;
+        pv_length[0] = 0;
+        for (int k = 0; k < list.size; ++k)
+        {
+            const int score = -search(Gen::apply(pos, list.moves[k]), depth - 1, -Variant_win - 1, -alpha, 1);
+            if (aborted)
+                break;
+            if (score > alpha)
+            {
+                alpha = score;
+                best = list.moves[k];
+                update_pv(0, best);
+            }
+        }
+        return alpha;
+    }
+
+    // Главная вариация последнего search_root
+    vector<Variant_move> principal_variation() const
+    {
+        return vector<Variant_move>(pv[0], pv[0] + pv_length[0]);
+    }
+
+    int64_t nodes = 0;
+    bool aborted = false;
+
+private:
+    static bool same(const Variant_move& a, const Variant_move& b)
+    {
+        return a.from == b.from && a.length == b.length && a.length && a.to() == b.to() && a.captured == b.captured;
+    }
+
+    bool should_stop()
+    {
+        if (!aborted && ((stop_flag && stop_flag->load(memory_order_relaxed)) || (max_nodes && nodes >= max_nodes) ||
+                         ((nodes & 1023) == 0 && chrono::steady_clock::now() >= stop_time)))
+            aborted = true;
+        return aborted;
+    }
+
+    // Ход m улучшил оценку на полуходе ply: вариация ply - m и вариация ply + 1
+    void update_pv(const int ply, const Variant_move& m)
+    {
+        pv[ply][0] = m;
+        for (int k = 0; k < pv_length[ply + 1]; ++k)
+            pv[ply][k + 1] = pv[ply + 1][k];
+        pv_length[ply] = pv_length[ply + 1] + 1;
+    }
+
+    int search(const Variant_position& pos, const int depth, int alpha, const int beta, const int ply)
+    {
+        ++nodes;
+        pv_length[ply] = 0;
+        pv_length[ply + 1] = 0;
+        if (should_stop())
+            return 0;
+        Move_list list;
+        Gen::generate(pos, list);
+        if (!list.size)
+            return -Variant_win + ply;
+        // взятия просчитываются и за пределом глубины, чтобы не оценивать позицию посреди размена
+        if ((depth <= 0 && !list.moves[0].captured) || ply >= Max_ply)
+            return evaluate(pos);
+        int best = -Variant_win - 1;
+        for (int k = 0; k < list.size; ++k)
+        {
+            const int score = -search(Gen::apply(pos, list.moves[k]), depth - 1, -beta, -alpha, ply + 1);
+            if (aborted)
+                return 0;
+            best = max(best, score);
+            if (score > alpha)
+            {
+                alpha = score;
+                update_pv(ply, list.moves[k]);
+            }
+            if (alpha >= beta)
+                break;
+        }
+        return best;
+    }
+
+    // Материал и продвижение простых шашек с точки зрения ходящего
+    static int evaluate(const Variant_position& pos)
+    {
+        int score = 0;
+        for (uint64_t m = pos.white; m; m &= m - 1)
+        {
+            const int sq = Gen::lowest(m);
+            score += (pos.kings & G::bit(sq)) ? Rules::King_value : 100 + 2 * (Rules::Size - 1 - G::row(sq));
+        }
+        for (uint64_t m = pos.black; m; m &= m - 1)
+        {
+            const int sq = Gen::lowest(m);
+            score -= (pos.kings & G::bit(sq)) ? Rules::King_value : 100 + 2 * G::row(sq);
+        }
+        return pos.color ? -score : score;
+    }
+
+    // Треугольная таблица вариаций: pv[ply] - лучшая найденная линия с полухода ply
+    Variant_move pv[Max_ply + 2][Max_ply + 1];
+    int pv_length[Max_ply + 2] = {};
+    const atomic<bool>* stop_flag = nullptr;
+    int64_t max_nodes = 0;
+    chrono::steady_clock::time_point stop_time = chrono::steady_clock::time_point::max();
+};
+
+template <class Rules> class Variant_engine : public Variant_engine_base
+{
+public:
+    using Gen = Move_generator<Rules>;
+    using G = Geometry<Rules::Size>;
+
+    Variant_engine()
+    {
+        set_start_position();
+    }
+
+    string name() const override
+    {
+        return Rules::Name;
+    }
+
+    // Черные занимают первые Rows рядов, белые - последние, ходят белые
+    void set_start_position() override
+    {
+        const int count = Rules::Rows * G::Row_squares;
+        pos = Variant_position();
+        pos.black = (1ULL << count) - 1;
+        pos.white = G::All & ~((1ULL << (G::Squares - count)) - 1);
+    }
+
+    bool set_position(const string& fen) override
+    {
+        Variant_position res;
+        stringstream ss(fen);
+        string part;
+        if (!getline(ss, part, ':') || (part != "W" && part != "B"))
+            return false;
+        res.color = (part == "B");
+        while (getline(ss, part, ':'))
+        {
+            if (part.empty() || (part[0] != 'W' && part[0] != 'B'))
+                return false;
+            uint64_t& side = (part[0] == 'W') ? res.white : res.black;
+            stringstream list(part.substr(1));
+            string item;
+            while (getline(list, item, ','))
+            {
+                if (!item.empty() && item.back() == '.')
+                    item.pop_back();
+                if (item.empty())
+                    continue;
+                const bool king = (item[0] == 'K');
+                if (king)
+                    item = item.substr(1);
+                const size_t dash = item.find('-');
+                int from = 0, to = 0;
+                if (!parse_square(item.substr(0, dash), from) ||
+                    !parse_square(dash == string::npos ? item : item.substr(dash + 1), to) || from > to)
+                    return false;
+                for (int sq = from; sq <= to; ++sq)
+                {
+                    side |= G::bit(sq - 1);
+                    if (king)
+                        res.kings |= G::bit(sq - 1);
+                }
+            }
+        }
+        pos = res;
+        return true;
+    }
+
+    const Variant_position& current() const
+    {
+        return pos;
+    }
+
+    string position() const override
+    {
+        string res = pos.color ? "B" : "W";
+        for (int side = 0; side < 2; ++side)
+        {
+            res += (side == 0 ? ":W" : ":B");
+            const uint64_t mask = side == 0 ? pos.white : pos.black;
+            bool first = true;
+            for (int sq = 0; sq < G::Squares; ++sq)
+            {
+                if (!(mask & G::bit(sq)))
+                    continue;
+                res += (first ? "" : ",") + string((pos.kings & G::bit(sq)) ? "K" : "") + to_string(sq + 1);
+                first = false;
+            }
+        }
+        return res;
+    }
+
+    vector<string> legal_moves() const override
+    {
+        Move_list list;
+        Gen::generate(pos, list);
+        vector<string> res;
+        for (int k = 0; k < list.size; ++k)
+            res.push_back(move_to_string(list.moves[k]));
+        return res;
+    }
+
+    bool play(const string& move) override
+    {
+        Move_list list;
+        Gen::generate(pos, list);
+        int found = -1, matches = 0;
+        for (int k = 0; k < list.size; ++k)
+        {
+            const Variant_move& m = list.moves[k];
+            if (move_to_string(m) == move)
+            {
+                found = k;
+                matches = 1;
+                break;
+            }
+            const char sep = m.captured ? 'x' : '-';
+            if (to_string(m.from + 1) + sep + to_string(m.to() + 1) == move)
+            {
+                found = k;
+                ++matches;
+            }
+        }
+        if (matches != 1)
+            return false;
+        pos = Gen::apply(pos, list.moves[found]);
+        return true;
+    }
+
+    Variant_result search(const Search_limits& limits,
+                          const function<void(const Variant_result&)>& on_depth = nullptr) override
+    {
+        const auto start = chrono::steady_clock::now();
+        searcher.set_limits(&stop_flag, limits.nodes,
+                            limits.time_ms ? start + chrono::milliseconds(limits.time_ms)
+                                           : chrono::steady_clock::time_point::max());
+        Variant_result res;
+        Variant_move best;
+        for (int depth = 1; depth <= limits.depth; ++depth)
+        {
+            Variant_move cur = best;
+            const int score = searcher.search_root(pos, depth, cur);
+            if (searcher.aborted || !cur.length)
+                break;
+            best = cur;
+            res.move = move_to_string(best);
+            res.pv.clear();
+            for (auto& m : searcher.principal_variation())
+                res.pv += (res.pv.empty() ? "" : " ") + move_to_string(m);
+            res.score = score;
+            res.depth = depth;
+            res.nodes = searcher.nodes;
+            res.time_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+            if (on_depth)
+                on_depth(res);
+            if (abs(score) >= Variant_win - Variant_search<Rules>::Max_ply)
+                break;
+        }
+        if (res.move.empty())
+        {
+            const auto moves = legal_moves();
+            if (!moves.empty())
+                res.move = res.pv = moves[0];
+        }
+        res.time_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        return res;
+    }
+
+    void stop() override
+    {
+        stop_flag = true;
+    }
+
+    void clear_stop() override
+    {
+        stop_flag = false;
+    }
+
+    uint64_t perft(const int depth) const override
+    {
+        return perft(pos, depth);
+    }
+
+    static string move_to_string(const Variant_move& m)
+    {
+        string res = to_string(m.from + 1);
+        for (int k = 0; k < m.length; ++k)
+            res += (m.captured ? "x" : "-") + to_string(m.path[k] + 1);
+        return res;
+    }
+
+private:
+    static uint64_t perft(const Variant_position& p, const int depth)
+    {
+        if (depth == 0)
+            return 1;
+        Move_list list;
+        Gen::generate(p, list);
+        if (depth == 1)
+            return uint64_t(list.size);
+        uint64_t res = 0;
+        for (int k = 0; k < list.size; ++k)
+            res += perft(Gen::apply(p, list.moves[k]), depth - 1);
+        return res;
+    }
+
+    static bool parse_square(const string& text, int& sq)
+    {
+        if (text.empty() || text.size() > 2 || !isdigit(text[0]) || !isdigit(text.back()))
+            return false;
+        sq = stoi(text);
+        return sq >= 1 && sq <= G::Squares;
+    }
+
+    Variant_position pos;
+    Variant_search<Rules> searcher;
+    atomic<bool> stop_flag{false};
+};
+
+// Движок по имени варианта ("russian", "english", "international"), nullptr - неизвестный вариант
+inline unique_ptr<Variant_engine_base> make_variant_engine(const string& name)
+{
+    if (name == Russian_rules::Name)
+        return make_unique<Variant_engine<Russian_rules>>();
+    if (name == English_rules::Name)
+        return make_unique<Variant_engine<English_rules>>();
+    if (name == International_rules::Name)
+        return make_unique<Variant_engine<International_rules>>();
+    return nullptr;
+}
@@ -1,10 +1,14 @@
 ﻿#pragma once
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
+#include <future>
 #include <vector>
 
-#include "../Models/Move.h"
+#include "../Models/Position.h"
 #include "../Models/Project_path.h"
+#include "Latency.h"
 
 #ifdef __APPLE__
 #include <SDL2/SDL.h>
@@ -30,8 +34,10 @@ public:
     // Инициализация и отрисовка игровой доски
     int start_draw()
     {
-        // Инициализация библиотеки SDL
-        if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+        const auto start = chrono::steady_clock::now();
+
+        // Инициализация только видео (вместе с ним - событий): звук, контроллеры и прочее игре не нужны
+        if (SDL_Init(SDL_INIT_VIDEO) != 0)
         {
             print_exception("SDL_Init can't init SDL2 lib");
             return 1;
@@ -64,20 +70,41 @@ public:
 
         // Создание рендерера для отрисовки
         ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        // без видеокарты (видеодрайвер dummy при прогоне сценария) - программная отрисовка
+        if (ren == nullptr)
+            ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_SOFTWARE);
         if (ren == nullptr)
         {
             print_exception("SDL_CreateRenderer can't create renderer");
             return 1;
         }
 
-        // Загрузка текстур для игры
-        board = IMG_LoadTexture(ren, board_path.c_str());
-        w_piece = IMG_LoadTexture(ren, piece_white_path.c_str());
-        b_piece = IMG_LoadTexture(ren, piece_black_path.c_str());
-        w_queen = IMG_LoadTexture(ren, queen_white_path.c_str());
-        b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
-        back = IMG_LoadTexture(ren, back_path.c_str());
-        replay = IMG_LoadTexture(ren, replay_path.c_str());
+        // Загрузка текстур для игры: PNG декодируются параллельно в потоках, в видеопамять
+        // текстуры загружаются в этом потоке (рендерер однопоточный). Доска показывается сразу,
+        // как только готова её текстура, не дожидаясь остальных
+        IMG_Init(IMG_INIT_PNG);
+        const string paths[] = {board_path, piece_white_path, piece_black_path, queen_white_path,
+                                queen_black_path, back_path, replay_path};
+        SDL_Texture** textures[] = {&board, &w_piece, &b_piece, &w_queen, &b_queen, &back, &replay};
+        vector<future<SDL_Surface*>> decoded;
+        for (auto& path : paths)
+            decoded.push_back(async(launch::async, [path]() { return IMG_Load(path.c_str()); }));
+        for (size_t k = 0; k < decoded.size(); ++k)
+        {
+            SDL_Surface* surface = decoded[k].get();
+            if (!surface)
+                continue;
+            *textures[k] = SDL_CreateTextureFromSurface(ren, surface);
+            SDL_FreeSurface(surface);
+            if (textures[k] == &board && board)
+            {
+                SDL_RenderClear(ren);
+                SDL_RenderCopy(ren, board, NULL, NULL);
+                SDL_RenderPresent(ren);
+                first_frame_ms =
+                    chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+            }
+        }
 
         // Проверка загрузки всех текстур
         if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
@@ -94,6 +121,7 @@ public:
 
         // Первоначальная отрисовка
         rerender();
+        ready_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
 
         return 0;
     }
@@ -102,11 +130,13 @@ public:
     void redraw()
     {
         game_results = -1; // Сброс результата игры
+        overlay.clear(); // Сброс строки поиска
         history_mtx.clear(); // Очистка истории ходов
         history_beat_series.clear(); // Очистка истории взятий
         make_start_mtx(); // Создание начальной расстановки
         clear_active(); // Сброс активной клетки
         clear_highlight(); // Сброс подсветки
+        reviewing = false; // Выход из разбора партии
     }
 
     // Перемещение фигуры с учетом взятия
@@ -163,31 +193,30 @@ public:
         rerender();
     }
 
-    // Получение текущего состояния доски
-    vector<vector<POS_T>> get_board() const
+    // Текущее состояние доски: ссылка только для чтения, без копии (движок ищет прямо по ней).
+    // Действительна, пока доска не меняется
+    const Position& get_board() const
     {
         return mtx;
     }
 
-    // Подсветка указанных клеток
-    void highlight_cells(vector<pair<POS_T, POS_T>> cells)
+    // Бит клетки (x, y) в маске подсветки
+    static uint64_t cell_bit(const POS_T x, const POS_T y)
     {
-        for (auto pos : cells)
-        {
-            POS_T x = pos.first, y = pos.second;
-            is_highlighted_[x][y] = 1;
-        }
+        return 1ULL << (x * 8 + y);
+    }
+
+    // Подсветка клеток маски (биты cell_bit) вместо прежней
+    void set_highlight(const uint64_t mask)
+    {
+        highlighted = mask;
         rerender();
     }
 
     // Сброс подсветки всех клеток
     void clear_highlight()
     {
-        for (POS_T i = 0; i < 8; ++i)
-        {
-            is_highlighted_[i].assign(8, 0);
-        }
-        rerender();
+        set_highlight(0);
     }
 
     // Установка активной клетки
@@ -207,9 +236,9 @@ public:
     }
 
     // Проверка подсветки клетки
-    bool is_highlighted(const POS_T x, const POS_T y)
+    bool is_highlighted(const POS_T x, const POS_T y) const
     {
-        return is_highlighted_[x][y];
+        return (highlighted & cell_bit(x, y)) != 0;
     }
 
     // Отмена последнего хода
@@ -233,6 +262,47 @@ public:
         rerender();
     }
 
+    // Просмотр разбора законченной партии: позиция, клетки хода (первая - начальная) и итог поверх
+    // доски (-1 - не показывается). Пока идёт просмотр, рядом с "Назад" рисуется кнопка "Вперёд"
+    void show_review(const Position& position, const vector<pair<POS_T, POS_T>>& cells, const int res)
+    {
+        reviewing = true;
+        mtx = position;
+        game_results = res;
+        highlighted = 0;
+        active_x = active_y = -1;
+        for (size_t k = 0; k < cells.size(); ++k)
+        {
+            if (k == 0)
+            {
+                active_x = cells[k].first;
+                active_y = cells[k].second;
+            }
+            else
+                highlighted |= cell_bit(cells[k].first, cells[k].second);
+        }
+        rerender();
+    }
+
+    // Замер времени кадров (nullptr - без замера), принадлежит вызывающему
+    void set_latency(Ui_latency* value)
+    {
+        latency = value;
+    }
+
+    // Строка поверх нижнего поля доски (ход поиска бота), пустая строка убирает её
+    void set_overlay(const string& text)
+    {
+        overlay = text;
+        rerender();
+    }
+
+    // Пока true, перерисовка оставляет события в очереди: их разбирает тот, кто ждёт ввода между кадрами
+    void set_keep_events(const bool value)
+    {
+        keep_events = value;
+    }
+
     // Обновление размеров окна
     void reset_window_size()
     {
@@ -289,6 +359,9 @@ private:
     // Полная перерисовка игрового поля
     void rerender()
     {
+        if (latency)
+            latency->frame_begin();
+
         // Очистка и отрисовка фона
         SDL_RenderClear(ren);
         SDL_RenderCopy(ren, board, NULL, NULL);
@@ -316,6 +389,7 @@ private:
                     piece_texture = b_queen;
 
                 SDL_RenderCopy(ren, piece_texture, NULL, &rect);
+            }
         }
 
         // Отрисовка подсветки
@@ -326,7 +400,7 @@ private:
         {
             for (POS_T j = 0; j < 8; ++j)
             {
-                if (!is_highlighted_[i][j])
+                if (!is_highlighted(i, j))
                     continue;
                 SDL_Rect cell{ int(W * (j + 1) / 10 / scale), int(H * (i + 1) / 10 / scale), int(W / 10 / scale),
                               int(H / 10 / scale) };
@@ -347,6 +421,11 @@ private:
         // Отрисовка кнопок управления
         SDL_Rect rect_left{ W / 40, H / 40, W / 15, H / 15 };
         SDL_RenderCopy(ren, back, NULL, &rect_left);
+        if (reviewing)
+        {
+            SDL_Rect rect_forward{ W / 10 + W / 40, H / 40, W / 15, H / 15 };
+            SDL_RenderCopyEx(ren, back, NULL, &rect_forward, 0, NULL, SDL_FLIP_HORIZONTAL);
+        }
         SDL_Rect replay_rect{ W * 109 / 120, H / 40, W / 15, H / 15 };
         SDL_RenderCopy(ren, replay, NULL, &replay_rect);
 
@@ -370,12 +449,74 @@ private:
             SDL_DestroyTexture(result_texture);
         }
 
+        // Отрисовка строки хода поиска
+        if (!overlay.empty())
+            draw_overlay();
+
         SDL_RenderPresent(ren);
+        if (latency)
+            latency->frame_end();
         SDL_Delay(10);
+        if (keep_events)
+        {
+            SDL_PumpEvents();
+            return;
+        }
         SDL_Event windowEvent;
         SDL_PollEvent(&windowEvent);
     }
 
+    // Строка overlay пиксельным шрифтом 5x7 на полупрозрачной подложке в нижнем поле доски
+    void draw_overlay()
+    {
+        const int len = int(overlay.size());
+        const int px = max(1, min(H / 100, W / (6 * len + 2)));
+        const int x0 = (W - (6 * len - 1) * px) / 2, y0 = H * 9 / 10 + (H / 10 - 7 * px) / 2;
+        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 160);
+        SDL_Rect back_rect{ x0 - 2 * px, y0 - 2 * px, (6 * len + 3) * px, 11 * px };
+        SDL_RenderFillRect(ren, &back_rect);
+        vector<SDL_Rect> pixels;
+        for (int k = 0; k < len; ++k)
+        {
+            const uint8_t* rows = glyph(overlay[k]);
+            for (int r = 0; r < 7; ++r)
+                for (int c = 0; c < 5; ++c)
+                    if (rows[r] & (16 >> c))
+                        pixels.push_back(SDL_Rect{ x0 + (6 * k + c) * px, y0 + r * px, px, px });
+        }
+        SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
+        SDL_RenderFillRects(ren, pixels.data(), int(pixels.size()));
+        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+    }
+
+    // Строки символа (5 младших бит, старший - левый столбец); неизвестные символы - пробел
+    static const uint8_t* glyph(const char c)
+    {
+        static const uint8_t digits[10][7] = {
+            {14, 17, 19, 21, 25, 17, 14}, {4, 12, 4, 4, 4, 4, 14},   {14, 17, 1, 2, 4, 8, 31},
+            {30, 1, 1, 14, 1, 1, 30},     {2, 6, 10, 18, 31, 2, 2},  {31, 16, 30, 1, 1, 17, 14},
+            {6, 8, 16, 30, 17, 17, 14},   {31, 1, 2, 4, 8, 8, 8},    {14, 17, 17, 14, 17, 17, 14},
+            {14, 17, 17, 15, 1, 2, 12}};
+        static const char letters[] = "-+.x/dkMnswilogaeb%urtmy";
+        static const uint8_t shapes[][7] = {
+            {0, 0, 0, 31, 0, 0, 0},        {0, 4, 4, 31, 4, 4, 0},       {0, 0, 0, 0, 0, 12, 12},
+            {0, 0, 17, 10, 4, 10, 17},     {1, 2, 2, 4, 8, 8, 16},       {1, 1, 13, 19, 17, 19, 13},
+            {16, 16, 18, 20, 24, 20, 18},  {17, 27, 21, 21, 17, 17, 17}, {0, 0, 22, 25, 17, 17, 17},
+            {0, 0, 15, 16, 14, 1, 30},     {0, 0, 17, 17, 21, 21, 10},   {4, 0, 12, 4, 4, 4, 14},
+            {12, 4, 4, 4, 4, 4, 14},       {0, 0, 14, 17, 17, 17, 14},   {0, 0, 15, 17, 15, 1, 14},
+            {0, 0, 14, 1, 15, 17, 15},     {0, 0, 14, 17, 31, 16, 14},   {16, 16, 22, 25, 17, 17, 30},
+            {24, 25, 2, 4, 8, 19, 3},      {0, 0, 17, 17, 17, 19, 13},   {0, 0, 22, 25, 16, 16, 16},
+            {8, 8, 28, 8, 8, 9, 6},        {0, 0, 26, 21, 21, 17, 17},   {0, 0, 17, 17, 15, 1, 14}};
+        static const uint8_t space[7] = {};
+        if (c >= '0' && c <= '9')
+            return digits[c - '0'];
+        for (int k = 0; letters[k]; ++k)
+            if (letters[k] == c)
+                return shapes[k];
+        return space;
+    }
+
     // Логирование ошибок
     void print_exception(const string& text) {
         ofstream fout(project_path + "log.txt", ios_base::app);
@@ -386,7 +527,9 @@ private:
 public:
     int W = 0; // Ширина окна
     int H = 0; // Высота окна
-    vector<vector<vector<POS_T>>> history_mtx; // История состояний доски
+    int64_t first_frame_ms = 0; // от начала start_draw до первого кадра (доска без фигур)
+    int64_t ready_ms = 0;       // от начала start_draw до кадра со всеми текстурами
+    vector<Position> history_mtx; // История состояний доски
 
 private:
     SDL_Window* win = nullptr; // Окно приложения
@@ -420,13 +563,21 @@ private:
     // Результат игры (-1 - игра продолжается)
     int game_results = -1;
 
-    // Матрица подсвеченных клеток
-    vector<vector<bool>> is_highlighted_ = vector<vector<bool>>(8, vector<bool>(8, 0));
+    // Идёт просмотр разбора партии (показывается кнопка "Вперёд")
+    bool reviewing = false;
+
+    // Строка хода поиска бота (пусто - не показывается)
+    string overlay;
+    Ui_latency* latency = nullptr; // замер времени кадров
+    bool keep_events = false; // перерисовка не забирает события из очереди (set_keep_events)
+
+    // Подсвеченные клетки: бит x * 8 + y
+    uint64_t highlighted = 0;
 
     // Текущее состояние доски
     // 0 - пусто, 1 - белая фигура, 2 - черная фигура
     // 3 - белая дамка, 4 - черная дамка
-    vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    Position mtx;
 
     // История количества взятий за ход
     vector<int> history_beat_series;
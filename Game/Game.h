@@ -1,21 +1,83 @@
 ﻿#pragma once
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <future>
 #include <thread>
 
+#include "../Engine/Game_analysis.h"
+#include "../Engine/Game_db.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Perf_counters.h"
 #include "../Models/Project_path.h"
 #include "Board.h"
 #include "Config.h"
 #include "Hand.h"
-#include "Logic.h"
+#include "Input_script.h"
+#include "Latency.h"
+
+// Допустимые ходы по клеткам (номер клетки x * 8 + y): строятся один раз на ход из logic.turns,
+// после чего клик игрока проверяется и переводится в ход без выделения памяти и просмотра списка
+struct Move_table
+{
+    uint64_t from = 0;     // клетки, с которых есть ход
+    uint64_t to[64] = {};  // клетки назначения каждой начальной клетки
+    uint8_t index[64][64]; // номер хода в logic.turns (действителен, если бит to установлен)
+
+    void build(const vector<move_pos>& turns)
+    {
+        from = 0;
+        fill(begin(to), end(to), 0);
+        for (size_t k = 0; k < turns.size(); ++k)
+        {
+            const int a = turns[k].x * 8 + turns[k].y, b = turns[k].x2 * 8 + turns[k].y2;
+            from |= Board::cell_bit(turns[k].x, turns[k].y);
+            to[a] |= Board::cell_bit(turns[k].x2, turns[k].y2);
+            index[a][b] = uint8_t(k);
+        }
+    }
+};
 
 class Game
 {
 public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    // Движок с настройками из settings.json создаётся в play() в фоне, пока открывается окно
+    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board)
     {
         // Очищаем лог-файл при создании игры
         ofstream fout(project_path + "log.txt", ios_base::trunc);
         fout.close();
+        if (config("Game", "LatencyStats"))
+            enable_latency();
+    }
+
+    // Замер задержек ввода и кадров: итоги пишутся в log.txt в конце каждой партии
+    void enable_latency()
+    {
+        measure_latency = true;
+        board.set_latency(&latency);
+        hand.set_latency(&latency);
+    }
+
+    // Партия по сценарию ввода из файла path (см. Input_script) с замером задержек; итоги печатаются в stdout
+    int play_script(const string& path)
+    {
+        Input_script script;
+        if (!script.load(path))
+        {
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Error: can't read input script " << path << "\n";
+            fout.close();
+            return 1;
+        }
+        enable_latency();
+        atomic<bool> stop{false};
+        thread driver([&]() { script.run(board, latency, stop); });
+        const int res = play();
+        stop = true;
+        driver.join();
+        printf("%s", latency.report().c_str());
+        return res;
     }
 
     // Основной метод запуска игры
@@ -26,16 +88,43 @@ public:
         // Обработка режима повтора игры
         if (is_replay)
         {
-            logic = Logic(&board, &config);  // Пересоздаем логику
+            // Тёплый перезапуск: сеть, кэш позиций, таблицы решателя и потоки MCTS остаются загруженными,
+            // заново загружается только то, чьи настройки изменились, и сбрасывается состояние партии
+            const auto restart = chrono::steady_clock::now();
             config.reload();                 // Обновляем конфигурацию
+            logic.configure(bot_options());
+            logic.new_game();
             board.redraw();                  // Перерисовываем доску
+
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Restart time: "
+                 << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - restart).count()
+                 << " millisec\n";
+            fout.close();
         }
         else
         {
+            // Движок (сеть, кэш позиций, таблицы решателя и MCTS) загружается в фоне, пока открывается окно
+            const auto start_up = chrono::steady_clock::now();
+            int64_t engine_ms = 0;
+            auto loading = async(launch::async, [this, start_up, &engine_ms]() {
+                Logic res(bot_options());
+                engine_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start_up).count();
+                return res;
+            });
             board.start_draw();  // Первоначальная отрисовка доски
+            logic = loading.get();
+
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Startup time: "
+                 << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start_up).count()
+                 << " millisec (first frame " << board.first_frame_ms << ", textures " << board.ready_ms
+                 << ", engine " << engine_ms << ")\n";
+            fout.close();
         }
 
         is_replay = false; // Сбрасываем флаг повтора
+        open_games_db();
 
         int turn_num = -1;      // Счетчик ходов
         bool is_quit = false;   // Флаг выхода из игры
@@ -46,8 +135,12 @@ public:
         {
             beat_series = 0;  // Сбрасываем счетчик серии взятий
 
+            // Позиции партии перед каждым ходом (после отмены ходов - с новой позиции)
+            positions.resize(turn_num);
+            positions.push_back(board.get_board());
+
             // Определяем доступные ходы для текущего игрока
-            logic.find_turns(turn_num % 2);
+            logic.find_turns(turn_num % 2, board.get_board());
 
             // Если ходов нет - завершаем игру
             if (logic.turns.empty())
@@ -55,11 +148,15 @@ public:
 
             // Устанавливаем сложность бота для текущего хода
             logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
+            logic.plies_left = Max_turns - 1 - turn_num;
 
             // Обработка хода игрока или бота
-            if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))
+            const bool is_player = !config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot"));
+            if (games_db.is_open())
+                board.set_overlay(is_player ? games_db_text(games_db.query(board.get_board(), turn_num % 2)) : "");
+            if (is_player)
             {
-                auto resp = player_turn(turn_num % 2);
+                auto resp = player_turn();
 
                 if (resp == Response::QUIT)  // Выход из игры
                 {
@@ -91,15 +188,20 @@ public:
                 }
             }
             else
+            {
+                logic.set_history(positions, false); // повторения позиций партии - ничьи для поиска
                 bot_turn(turn_num % 2);  // Ход бота
             }
         }
 
         auto end = chrono::steady_clock::now(); // Фиксируем время окончания
+        logic.flush_cache(); // Результаты поиска этой партии - на диск
 
         // Логируем время игры
         ofstream fout(project_path + "log.txt", ios_base::app);
         fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+        if (measure_latency)
+            fout << latency.report();
         fout.close();
 
         // Обработка запроса на повтор
@@ -120,11 +222,16 @@ public:
         {
             res = 1; // Победа одного из игроков
         }
+        save_game(res);
 
         board.show_final(res); // Отображение финального экрана
 
-        // Ожидание реакции игрока
-        auto resp = hand.wait();
+        // Разбор партии и ожидание реакции игрока (листание разбора, рестарт или выход);
+        // рестарт или выход во время разбора прерывают его
+        vector<Move_annotation> moves;
+        auto resp = analyze_game(moves);
+        if (resp == Response::OK)
+            resp = review(moves, res);
 
         // Обработка запроса на повтор
         if (resp == Response::REPLAY)
@@ -137,6 +244,240 @@ public:
     }
 
 private:
+    // Счётчики процессора открываются при первом замере; если они недоступны, причина пишется в лог один раз
+    bool perf_ready()
+    {
+        if (!perf.is_open() && !perf_failed && !perf.open())
+        {
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Error: hardware counters unavailable: " << perf.error() << "\n";
+            fout.close();
+            perf_failed = true;
+        }
+        return perf.is_open();
+    }
+
+    // База партий Game/GameDatabase открывается заново в каждой партии (её могли пересобрать)
+    void open_games_db()
+    {
+        const string db_path = config("Game", "GameDatabase");
+        const string path = db_path.empty() ? "" : project_path + db_path;
+        // та же база с прошлой партии остаётся открытой
+        if (path == games_db_path && (path.empty() || games_db.is_open()))
+            return;
+        games_db.close();
+        games_db_path = path;
+        if (path.empty() || games_db.open(path))
+            return;
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << "Error: can't open game database " << project_path + db_path << "\n";
+        fout.close();
+    }
+
+    // Строка базы партий: партий через позицию, итоги (белые, ничьи, черные) и самое частое продолжение
+    static string games_db_text(const Game_db::Position_stats& s)
+    {
+        string res = to_string(s.games) + " games";
+        if (!s.games)
+            return res;
+        auto pct = [&](const uint32_t n) { return to_string(lround(100.0 * n / s.games)) + "%"; };
+        res += " w" + pct(s.white_wins) + " d" + pct(s.draws) + " b" + pct(s.black_wins);
+        if (!s.moves[0].move.empty())
+            res += " " + s.moves[0].move;
+        return res;
+    }
+
+    // Позиции законченной партии перед каждым ходом и последняя (после лимита ходов её в positions ещё нет)
+    vector<Position> game_positions() const
+    {
+        auto res = positions;
+        if (res.empty() || res.back() != board.get_board())
+            res.push_back(board.get_board());
+        return res;
+    }
+
+    // Законченная партия дописывается в PDN-файл Game/GameLog (из него Tools/game_db.cpp собирает базу).
+    // res - как у show_final: 0 ничья, 1 победа белых, 2 победа черных
+    void save_game(const int res)
+    {
+        const string log_path = config("Game", "GameLog");
+        if (log_path.empty())
+            return;
+        const int8_t result =
+            res == 0 ? Game_record::Draw : (res == 1 ? Game_record::White_win : Game_record::Black_win);
+        Game_record record;
+        ofstream fout;
+        if (Game_db::from_positions(game_positions(), false, result, record))
+        {
+            fout.open(project_path + log_path, ios_base::app);
+            fout << Game_db::write_pdn(record);
+        }
+        if (!fout)
+        {
+            ofstream log(project_path + "log.txt", ios_base::app);
+            log << "Error: can't write the game to " << project_path + log_path << "\n";
+        }
+    }
+
+    // Разбор законченной партии на всех ядрах на глубину Game/AnalysisDepth (0 - без разбора) в res;
+    // пока он идёт, внизу доски показывается число законченных поисков. Рестарт или выход во время
+    // разбора прерывают его (после текущих поисков) и возвращаются, иначе OK
+    Response analyze_game(vector<Move_annotation>& res)
+    {
+        res.clear();
+        const int depth = config("Game", "AnalysisDepth");
+        const auto game = game_positions();
+        if (depth <= 0 || game.size() < 2)
+            return Response::OK;
+        // игрок ушёл с финального экрана раньше, чем начался разбор
+        Response resp = hand.poll();
+        if (resp == Response::QUIT || resp == Response::REPLAY)
+            return resp;
+        resp = Response::OK;
+        const auto start = chrono::steady_clock::now();
+        Analysis_options opt;
+        opt.bot = bot_options();
+        opt.depth = depth;
+        opt.time_ms = config("Game", "AnalysisMS");
+        atomic<int> done{0};
+        atomic<bool> stop{false};
+        const string total = "/" + to_string(2 * (game.size() - 1));
+        auto job = async(launch::async, [&]() { return Game_analysis::analyze(game, false, opt, &done, &stop); });
+        // события разбираются здесь, перерисовка строки их не забирает
+        board.set_keep_events(true);
+        while (job.wait_for(chrono::milliseconds(100)) != future_status::ready)
+        {
+            resp = hand.poll();
+            if (resp == Response::QUIT || resp == Response::REPLAY)
+            {
+                stop = true;
+                break;
+            }
+            resp = Response::OK;
+            board.set_overlay("analysis " + to_string(done) + total);
+        }
+        board.set_keep_events(false);
+        res = job.get();
+        if (resp != Response::OK)
+        {
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Analysis cancelled after "
+                 << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count()
+                 << " millisec\n";
+            return resp;
+        }
+
+        int marks[3] = {};
+        for (auto& a : res)
+            ++marks[a.kind];
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << "Analysis time: "
+             << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count()
+             << " millisec (" << marks[Move_annotation::Blunder] << " blunders, "
+             << marks[Move_annotation::Missed_win] << " missed wins)\n";
+        fout.close();
+        return Response::OK;
+    }
+
+    // Просмотр разбора на финальном экране: "назад" и "вперёд" переходят к предыдущей и следующей
+    // ошибке или упущенному выигрышу (позиция перед ходом, сделанный ход подсвечен, внизу - лучший),
+    // "вперёд" после последней возвращает итог партии. Возвращает ответ, завершивший просмотр
+    Response review(const vector<Move_annotation>& moves, const int res)
+    {
+        const auto game = game_positions();
+        vector<size_t> marked;
+        int marks[3] = {};
+        for (size_t k = 0; k < moves.size(); ++k)
+        {
+            ++marks[moves[k].kind];
+            if (moves[k].kind != Move_annotation::None)
+                marked.push_back(k);
+        }
+        string summary;
+        if (!moves.empty())
+            summary = to_string(marks[Move_annotation::Blunder]) + " blunders " +
+                      to_string(marks[Move_annotation::Missed_win]) + " missed wins";
+        board.set_overlay(summary);
+        size_t cur = marked.size(); // marked.size() - итог партии
+        while (true)
+        {
+            const auto resp = hand.wait();
+            if (resp == Response::BACK && cur > 0)
+                --cur;
+            else if (resp == Response::FORWARD && cur < marked.size())
+                ++cur;
+            else if (resp == Response::BACK || resp == Response::FORWARD)
+                continue;
+            else
+                return resp;
+            if (cur == marked.size())
+            {
+                board.show_review(game.back(), {}, res);
+                board.set_overlay(summary);
+                continue;
+            }
+            const size_t k = marked[cur];
+            const auto& a = moves[k];
+            vector<pair<POS_T, POS_T>> cells{{a.played[0].x, a.played[0].y}};
+            for (auto& step : a.played)
+                cells.emplace_back(step.x2, step.y2);
+            board.show_review(game[k], cells, -1);
+            board.set_overlay(to_string(k / 2 + 1) + (k % 2 ? "... " : ". ") + Engine::move_to_string(a.played) +
+                              (a.kind == Move_annotation::Blunder ? " blunder" : " missed win") + " best " +
+                              Engine::move_to_string(a.best));
+        }
+    }
+
+    // Настройки движка из раздела Bot файла settings.json
+    Bot_options bot_options() const
+    {
+        Bot_options options;
+        options.no_random = config("Bot", "NoRandom");
+        options.scoring = Bot_options::parse_scoring(config("Bot", "BotScoringType"));
+        options.optimization = Bot_options::parse_optimization(config("Bot", "Optimization"));
+        const string nnue_path = config("Bot", "NNUEPath");
+        options.nnue_path = project_path + nnue_path;
+        const string ntuple_path = config("Bot", "NTuplePath");
+        options.ntuple_path = project_path + ntuple_path;
+        const string cache_path = config("Bot", "PositionCache");
+        if (!cache_path.empty())
+            options.cache_path = project_path + cache_path;
+        options.cache_mb = config("Bot", "PositionCacheMB");
+        options.solver_pieces = config("Bot", "SolverPieces");
+        options.solver_ms = config("Bot", "SolverMS");
+        options.search = Bot_options::parse_search(config("Bot", "BotEngine"));
+        options.mcts_ms = config("Bot", "MCTSTimeMS");
+        options.mcts_threads = config("Bot", "MCTSThreads");
+        return options;
+    }
+
+    // Строка хода поиска: глубина, скорость, время, лучший ход и оценка
+    // (ln отношения сил с точки зрения бота, как score cp / 100 в engine_server)
+    static string stats_text(const Search_stats::Snapshot& s)
+    {
+        char buf[32];
+        const double nps = s.elapsed_ms ? s.nodes * 1000.0 / s.elapsed_ms : 0;
+        string res = "d" + to_string(s.depth) + " ";
+        if (nps >= 1e6)
+            snprintf(buf, sizeof(buf), "%.1fM", nps / 1e6);
+        else
+            snprintf(buf, sizeof(buf), "%.0fk", nps / 1e3);
+        res += string(buf) + "n/s ";
+        snprintf(buf, sizeof(buf), "%.1fs", s.elapsed_ms / 1000.0);
+        res += buf;
+        if (!s.has_best)
+            return res;
+        res += " " + to_string(s.path[0] + 1);
+        for (size_t k = 1; k < s.path.size(); ++k)
+            res += (s.capture ? "x" : "-") + to_string(s.path[k] + 1);
+        if (is_win(s.score))
+            return res + " win in " + to_string(plies_to_end(s.score));
+        if (is_loss(s.score))
+            return res + " loss in " + to_string(plies_to_end(s.score));
+        snprintf(buf, sizeof(buf), " %+.2f", log(s.score));
+        return res + buf;
+    }
+
     // Обработка хода бота
     void bot_turn(const bool color)
     {
@@ -148,8 +489,39 @@ private:
         // Поток для реализации задержки
         thread th(SDL_Delay, delay_ms);
 
-        // Поиск оптимальных ходов
-        auto turns = logic.find_best_turns(color);
+        // Поиск оптимальных ходов; со строкой хода поиска поиск идёт в отдельном потоке,
+        // а окно раз в 100 мс перерисовывает снимок Search_stats
+        vector<move_pos> turns;
+        const bool measure = config("Bot", "PerfCounters") && perf_ready();
+        const int64_t nodes_before = logic.nodes;
+        if (measure)
+            perf.start();
+        if (config("Bot", "ShowSearchStats"))
+        {
+            const auto mtx = board.get_board();
+            atomic<bool> done{false};
+            logic.set_stats(&search_stats);
+            thread search([&]() {
+                turns = logic.find_best_turns(mtx, color);
+                done = true;
+            });
+            // перерисовка строки не забирает события: клики и закрытие окна во время поиска
+            // разбираются после хода бота, как при поиске без строки
+            board.set_keep_events(true);
+            while (!done)
+            {
+                board.set_overlay(stats_text(search_stats.read()));
+                this_thread::sleep_for(chrono::milliseconds(100));
+            }
+            search.join();
+            logic.set_stats(nullptr);
+            board.set_overlay(stats_text(search_stats.read()));
+            board.set_keep_events(false);
+        }
+        else
+            turns = logic.find_best_turns(board.get_board(), color);
+        const auto perf_sample = measure ? perf.stop() : Perf_counters::Sample();
+        const int64_t search_nodes = logic.nodes - nodes_before;
 
         th.join(); // Ожидание завершения задержки
 
@@ -174,20 +546,27 @@ private:
 
         // Логирование времени хода
         ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec";
+        if (logic.cache_hit_depth != -1)
+            fout << " (position cache, depth " << logic.cache_hit_depth << ")";
+        if (logic.solver_status == Solve_status::Win)
+            fout << " (solver: win in " << logic.solver_length << " plies)";
+        else if (logic.solver_status == Solve_status::Loss)
+            fout << " (solver: loss in " << logic.solver_length << " plies)";
+        else if (logic.solver_status == Solve_status::Draw)
+            fout << " (solver: draw)";
+        if (measure)
+            fout << " [nodes " << search_nodes << ", " << perf_sample.format(search_nodes) << "]";
+        fout << "\n";
         fout.close();
     }
 
     // Обработка хода игрока
-    Response player_turn(const bool color)
+    Response player_turn()
     {
-        // Подсветка доступных ходов
-        vector<pair<POS_T, POS_T>> cells;
-        for (auto turn : logic.turns)
-        {
-            cells.emplace_back(turn.x, turn.y);
-        }
-        board.highlight_cells(cells);
+        // Подсветка доступных ходов (logic.turns найдены в play); клики проверяются по таблице ходов без просмотра списка
+        moves.build(logic.turns);
+        board.set_highlight(moves.from);
 
         move_pos pos = {-1, -1, -1, -1};
         POS_T x = -1, y = -1;
@@ -199,63 +578,43 @@ private:
             if (get<0>(resp) != Response::CELL)
                 return get<0>(resp);
 
-            pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};
+            const POS_T cx = get<1>(resp), cy = get<2>(resp);
 
-            // Проверка корректности хода
-            bool is_correct = false;
-            for (auto turn : logic.turns)
+            // Ход выбранной фигурой на эту клетку
+            if (x != -1 && (moves.to[x * 8 + y] & Board::cell_bit(cx, cy)))
             {
-                if (turn.x == cell.first && turn.y == cell.second)
-                {
-                    is_correct = true;
-                    break;
-                }
-                if (turn == move_pos{x, y, cell.first, cell.second})
-                {
-                    pos = turn;
-                    break;
-                }
-            }
-
-            if (pos.x != -1)
+                pos = logic.turns[moves.index[x * 8 + y][cx * 8 + cy]];
                 break;
+            }
 
             // Обработка некорректного хода
-            if (!is_correct)
+            if (!(moves.from & Board::cell_bit(cx, cy)))
             {
                 if (x != -1)
                 {
                     board.clear_active();
-                    board.clear_highlight();
-                    board.highlight_cells(cells);
+                    board.set_highlight(moves.from);
                 }
                 x = -1;
                 y = -1;
                 continue;
             }
 
-            // Обновление интерфейса при корректном ходе
-            x = cell.first;
-            y = cell.second;
-            board.clear_highlight();
+            // Обновление интерфейса при корректном ходе и подсветка следующих возможных ходов
+            x = cx;
+            y = cy;
             board.set_active(x, y);
-
-            // Подсветка следующих возможных ходов
-            vector<pair<POS_T, POS_T>> cells2;
-            for (auto turn : logic.turns)
-            {
-                if (turn.x == x && turn.y == y)
-                {
-                    cells2.emplace_back(turn.x2, turn.y2);
-                }
-            }
-            board.highlight_cells(cells2);
+            board.set_highlight(moves.to[x * 8 + y]);
+            if (measure_latency)
+                latency.complete(Ui_latency::Highlight);
         }
 
         // Выполнение хода
         board.clear_highlight();
         board.clear_active();
         board.move_piece(pos, pos.xb != -1);
+        if (measure_latency)
+            latency.complete(Ui_latency::Move);
 
         // Завершение хода если не было взятия
         if (pos.xb == -1)
@@ -265,17 +624,14 @@ private:
         beat_series = 1;
         while (true)
         {
-            logic.find_turns(pos.x2, pos.y2);
+            logic.find_turns(pos.x2, pos.y2, board.get_board());
             if (!logic.have_beats)
                 break;
 
             // Подсветка доступных взятий
-            vector<pair<POS_T, POS_T>> cells;
-            for (auto turn : logic.turns)
-            {
-                cells.emplace_back(turn.x2, turn.y2);
-            }
-            board.highlight_cells(cells);
+            moves.build(logic.turns);
+            const int from = pos.x2 * 8 + pos.y2;
+            board.set_highlight(moves.to[from]);
             board.set_active(pos.x2, pos.y2);
 
             // Ожидание выбора взятия
@@ -285,26 +641,17 @@ private:
                 if (get<0>(resp) != Response::CELL)
                     return get<0>(resp);
 
-                pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};
-
-                bool is_correct = false;
-                for (auto turn : logic.turns)
-                {
-                    if (turn.x2 == cell.first && turn.y2 == cell.second)
-                    {
-                        is_correct = true;
-                        pos = turn;
-                        break;
-                    }
-                }
-
-                if (!is_correct)
+                const POS_T cx = get<1>(resp), cy = get<2>(resp);
+                if (!(moves.to[from] & Board::cell_bit(cx, cy)))
                     continue;
+                pos = logic.turns[moves.index[from][cx * 8 + cy]];
 
                 board.clear_highlight();
                 board.clear_active();
                 beat_series += 1;
                 board.move_piece(pos, beat_series);
+                if (measure_latency)
+                    latency.complete(Ui_latency::Move);
                 break;
             }
         }
@@ -317,6 +664,15 @@ private:
     Board board;          // Игровая доска
     Hand hand;            // Обработчик ввода
     Logic logic;          // Игровая логика
+    Search_stats search_stats; // ход поиска бота для строки поверх доски
+    Perf_counters perf;   // счётчики процессора для замера хода бота (Bot/PerfCounters)
+    bool perf_failed = false; // счётчики недоступны - причина уже записана в лог
+    Ui_latency latency;   // задержки ввода и время кадров (Game/LatencyStats, сценарий ввода)
+    bool measure_latency = false;
     int beat_series;      // Счетчик серии взятий
+    vector<Position> positions; // позиции партии перед каждым ходом
+    Move_table moves;     // допустимые ходы игрока по клеткам (player_turn)
+    Game_db games_db;     // база партий для строки статистики позиции (Game/GameDatabase)
+    string games_db_path; // путь открытой базы партий
     bool is_replay = false; // Флаг повтора игры
 }; 
\ No newline at end of file
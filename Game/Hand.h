@@ -1,9 +1,11 @@
 ﻿#pragma once
+#include <chrono>
 #include <tuple>
 
 #include "../Models/Move.h"
 #include "../Models/Response.h"
 #include "Board.h"
+#include "Latency.h"
 
 // Класс для обработки пользовательского ввода (мышь, кнопки)
 class Hand
@@ -14,6 +16,12 @@ public:
     {
     }
 
+    // Замер задержки ввода (nullptr - без замера), принадлежит вызывающему
+    void set_latency(Ui_latency* value)
+    {
+        latency = value;
+    }
+
     // Обрабатывает клик мыши и возвращает:
     // - тип действия (выбор клетки/кнопки/выход)
     // - координаты выбранной клетки (если применимо)
@@ -24,6 +32,8 @@ public:
         int x = -1, y = -1;    // Экранные координаты клика
         int xc = -1, yc = -1;  // Координаты на игровой доске
 
+        if (latency)
+            latency->set_waiting(true);
         while (true)
         {
             if (SDL_PollEvent(&windowEvent))
@@ -35,6 +45,14 @@ public:
                     break;
 
                 case SDL_MOUSEBUTTONDOWN: // Обработка клика мыши
+                    // время клика - момент появления события в очереди SDL; ожидание снимается раньше,
+                    // чем клик засчитан, чтобы сценарий ввода не отправил следующий клик до реакции на этот
+                    if (latency)
+                    {
+                        latency->set_waiting(false);
+                        latency->click(chrono::steady_clock::now() -
+                                       chrono::milliseconds(SDL_GetTicks() - windowEvent.button.timestamp));
+                    }
                     x = windowEvent.motion.x;
                     y = windowEvent.motion.y;
 
@@ -61,6 +79,8 @@ public:
                     {
                         xc = -1;
                         yc = -1;
+                        if (latency)
+                            latency->set_waiting(true);
                     }
                     break;
 
@@ -76,50 +96,85 @@ public:
                     break;
             }
         }
+        if (latency)
+            latency->set_waiting(false);
         return {resp, xc, yc};
     }
 
-    // Ожидает действия пользователя (используется для финального экрана)
+    // Ожидает действия пользователя (используется для финального экрана): рестарт, выход,
+    // "назад" и "вперёд" по разбору партии (кнопки или стрелки влево и вправо)
     Response wait() const
     {
         SDL_Event windowEvent;
         Response resp = Response::OK;
 
-        while (true)
+        if (latency)
+            latency->set_waiting(true);
+        while (resp == Response::OK)
         {
             if (SDL_PollEvent(&windowEvent))
-            {
-                switch (windowEvent.type)
-                {
-                case SDL_QUIT: // Закрытие окна
-                    resp = Response::QUIT;
-                    break;
+                resp = final_response(windowEvent);
+        }
+        if (latency)
+            latency->set_waiting(false);
+        return resp;
+    }
 
-                case SDL_WINDOWEVENT_SIZE_CHANGED: // Изменение размера
-                    board->reset_window_size();
-                    break;
+    // Действие пользователя из уже пришедших событий, без ожидания (OK - действия не было).
+    // События разбираются как в wait(); нужно, пока финальный экран занят разбором партии
+    Response poll() const
+    {
+        SDL_Event windowEvent;
+        Response resp = Response::OK;
+        while (resp == Response::OK && SDL_PollEvent(&windowEvent))
+            resp = final_response(windowEvent);
+        return resp;
+    }
 
-                case SDL_MOUSEBUTTONDOWN: // Обработка клика
-                {
-                    int x = windowEvent.motion.x;
-                    int y = windowEvent.motion.y;
-                    int xc = int(y / (board->H / 10) - 1);
-                    int yc = int(x / (board->W / 10) - 1);
+private:
+    // Действие финального экрана по событию (OK - событие ничего не меняет)
+    Response final_response(const SDL_Event& windowEvent) const
+    {
+        Response resp = Response::OK;
+        switch (windowEvent.type)
+        {
+        case SDL_QUIT: // Закрытие окна
+            resp = Response::QUIT;
+            break;
 
-                    // Проверка нажатия кнопки "Рестарт"
-                    if (xc == -1 && yc == 8)
-                        resp = Response::REPLAY;
-                }
-                break;
-                }
+        case SDL_WINDOWEVENT_SIZE_CHANGED: // Изменение размера
+            board->reset_window_size();
+            break;
 
-                if (resp != Response::OK)
-                    break;
-            }
+        case SDL_MOUSEBUTTONDOWN: // Обработка клика
+        {
+            if (latency)
+                latency->click(chrono::steady_clock::now());
+            int x = windowEvent.motion.x;
+            int y = windowEvent.motion.y;
+            int xc = int(y / (board->H / 10) - 1);
+            int yc = int(x / (board->W / 10) - 1);
+
+            // Проверка нажатия кнопок "Рестарт", "Назад" и "Вперёд"
+            if (xc == -1 && yc == 8)
+                resp = Response::REPLAY;
+            else if (xc == -1 && yc == -1)
+                resp = Response::BACK;
+            else if (xc == -1 && yc == 0)
+                resp = Response::FORWARD;
+        }
+        break;
+
+        case SDL_KEYDOWN: // Стрелки листают разбор партии
+            if (windowEvent.key.keysym.sym == SDLK_LEFT)
+                resp = Response::BACK;
+            else if (windowEvent.key.keysym.sym == SDLK_RIGHT)
+                resp = Response::FORWARD;
+            break;
         }
         return resp;
     }
 
-private:
     Board* board; // Указатель на игровую доску (для расчета координат)
+    Ui_latency* latency = nullptr; // замер задержки ввода
 };  
\ No newline at end of file
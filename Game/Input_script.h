@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Board.h"
+#include "Latency.h"
+
+// Сценарий ввода для замеров без человека: ходы игрока номерами клеток ("22-18", "22x15x6",
+// по одному или несколько в строке, # - комментарий до конца строки) превращаются в клики по клеткам,
+// которые подаются в очередь SDL из отдельного потока. Следующий клик отправляется, когда окно
+// взяло предыдущий и снова ждёт ввода (ход бота при этом не мешает). В конце отправляется SDL_QUIT
+class Input_script
+{
+public:
+    static const int Click_pause_ms = 20; // пауза перед кликом, как у быстрого игрока
+
+    bool load(const string& path)
+    {
+        ifstream fin(path);
+        if (!fin)
+            return false;
+        cells.clear();
+        string line;
+        while (getline(fin, line))
+        {
+            line = line.substr(0, line.find('#'));
+            stringstream ss(line);
+            string move;
+            while (ss >> move)
+            {
+                stringstream squares(move);
+                string item;
+                while (getline(squares, item, move.find('x') != string::npos ? 'x' : '-'))
+                {
+                    const int sq = atoi(item.c_str());
+                    if (sq < 1 || sq > 32)
+                        return false;
+                    // нумерация клеток как в Engine: 1..32 по тёмным полям сверху вниз
+                    const int row = (sq - 1) / 4;
+                    cells.emplace_back(row, 2 * ((sq - 1) % 4) + (row % 2 == 0 ? 1 : 0));
+                }
+            }
+        }
+        return true;
+    }
+
+    // Подача кликов; stop - игра закончилась, ждать ввода больше некому
+    void run(const Board& board, const Ui_latency& latency, const atomic<bool>& stop) const
+    {
+        int64_t pushed = 0;
+        for (auto cell : cells)
+        {
+            if (!wait_ready(latency, pushed, stop))
+                return;
+            this_thread::sleep_for(chrono::milliseconds(Click_pause_ms));
+            SDL_Event event;
+            SDL_zero(event);
+            event.type = SDL_MOUSEBUTTONDOWN;
+            event.button.button = SDL_BUTTON_LEFT;
+            event.button.state = SDL_PRESSED;
+            event.button.clicks = 1;
+            event.button.x = board.W * (cell.second + 1) / 10 + board.W / 20;
+            event.button.y = board.H * (cell.first + 1) / 10 + board.H / 20;
+            SDL_PushEvent(&event);
+            ++pushed;
+        }
+        if (!wait_ready(latency, pushed, stop))
+            return;
+        SDL_Event event;
+        SDL_zero(event);
+        event.type = SDL_QUIT;
+        SDL_PushEvent(&event);
+    }
+
+private:
+    static bool wait_ready(const Ui_latency& latency, const int64_t pushed, const atomic<bool>& stop)
+    {
+        while (!stop && !(latency.is_waiting() && latency.clicks_taken() >= pushed))
+            this_thread::sleep_for(chrono::milliseconds(1));
+        return !stop;
+    }
+
+    vector<pair<int, int>> cells; // клетки кликов (строка, столбец)
+};
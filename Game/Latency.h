@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Замер отзывчивости окна: время от клика до кадра, на котором видна реакция, и время кадров.
+// Hand отмечает клики (click), Board - начало отрисовки и SDL_RenderPresent (frame_begin, frame_end),
+// Game - момент, когда реакция на последний клик показана (complete). Клики без реакции
+// (мимо допустимых клеток) не учитываются. Пишут поток окна и поток сценария ввода, поэтому под мьютексом
+class Ui_latency
+{
+public:
+    enum Kind
+    {
+        Highlight, // клик по шашке - подсветка её ходов
+        Move,      // клик по клетке хода - шашка на новом месте
+        Kinds
+    };
+
+    using Clock = chrono::steady_clock;
+
+    void click(const Clock::time_point t)
+    {
+        lock_guard<mutex> lock(m);
+        pending = t;
+        has_pending = true;
+        ++clicks;
+    }
+
+    void frame_begin()
+    {
+        lock_guard<mutex> lock(m);
+        render_start = Clock::now();
+    }
+
+    void frame_end()
+    {
+        lock_guard<mutex> lock(m);
+        const auto now = Clock::now();
+        render_ms.push_back(ms(render_start, now));
+        if (has_present)
+            interval_ms.push_back(ms(last_present, now));
+        last_present = now;
+        has_present = true;
+    }
+
+    // Реакция на последний клик показана последним кадром
+    void complete(const Kind kind)
+    {
+        lock_guard<mutex> lock(m);
+        if (!has_pending || !has_present)
+            return;
+        latency_ms[kind].push_back(ms(pending, last_present));
+        has_pending = false;
+    }
+
+    // Ввод ждёт клика (для сценария ввода: следующий клик отправляется, когда предыдущий уже взят)
+    void set_waiting(const bool value)
+    {
+        waiting = value;
+    }
+
+    bool is_waiting() const
+    {
+        return waiting;
+    }
+
+    int64_t clicks_taken() const
+    {
+        lock_guard<mutex> lock(m);
+        return clicks;
+    }
+
+    // Итоги: p50/p99/max и гистограмма по степеням двойки миллисекунд
+    string report() const
+    {
+        lock_guard<mutex> lock(m);
+        string res = "UI latency (" + to_string(clicks) + " clicks):\n";
+        res += line("click-to-highlight", latency_ms[Highlight]);
+        res += line("click-to-move", latency_ms[Move]);
+        res += line("frame render", render_ms);
+        res += line("frame interval", interval_ms);
+        return res;
+    }
+
+private:
+    static double ms(const Clock::time_point a, const Clock::time_point b)
+    {
+        return chrono::duration<double, milli>(b - a).count();
+    }
+
+    static string line(const string& name, vector<double> v)
+    {
+        char buf[160];
+        if (v.empty())
+            return name + ": no samples\n";
+        sort(v.begin(), v.end());
+        auto pct = [&](const double p) { return v[min(v.size() - 1, size_t(p * (v.size() - 1) + 0.5))]; };
+        snprintf(buf, sizeof(buf), "%s: %zu samples, p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", name.c_str(), v.size(),
+                 pct(0.5), pct(0.99), v.back());
+        string res = buf;
+        // корзины [0, 1), [1, 2), [2, 4), ... миллисекунд
+        vector<size_t> buckets;
+        for (double x : v)
+        {
+            size_t b = 0;
+            for (double edge = 1; x >= edge && b < 15; edge *= 2)
+                ++b;
+            if (buckets.size() <= b)
+                buckets.resize(b + 1);
+            ++buckets[b];
+        }
+        res += "  ";
+        for (size_t b = 0; b < buckets.size(); ++b)
+        {
+            if (!buckets[b])
+                continue;
+            snprintf(buf, sizeof(buf), " <%d ms: %zu", 1 << b, buckets[b]);
+            res += buf;
+        }
+        return res + "\n";
+    }
+
+    mutable mutex m;
+    atomic<bool> waiting{false};
+    int64_t clicks = 0;
+    bool has_pending = false;
+    Clock::time_point pending;       // время последнего клика без показанной реакции
+    bool has_present = false;
+    Clock::time_point last_present;  // время последнего SDL_RenderPresent
+    Clock::time_point render_start;
+    vector<double> latency_ms[Kinds];
+    vector<double> render_ms;
+    vector<double> interval_ms;
+};
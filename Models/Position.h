@@ -0,0 +1,31 @@
+#pragma once
+#include <array>
+
+#include "Move.h"
+
+// Позиция доски: 64 клетки подряд в массиве фиксированного размера, клетка (i, j) - cells[i * 8 + j]
+// (0 - пусто, 1..4 - фигуры). Копия - 64 байта без выделения памяти, mtx[i][j] - как у матрицы 8x8
+struct Position
+{
+    std::array<POS_T, 64> cells{};
+
+    POS_T* operator[](const int i)
+    {
+        return cells.data() + i * 8;
+    }
+
+    const POS_T* operator[](const int i) const
+    {
+        return cells.data() + i * 8;
+    }
+
+    bool operator==(const Position& other) const
+    {
+        return cells == other.cells;
+    }
+
+    bool operator!=(const Position& other) const
+    {
+        return cells != other.cells;
+    }
+};
@@ -4,6 +4,7 @@ enum class Response
 {
     OK,
     BACK,
+    FORWARD,
     REPLAY,
     QUIT,
     CELL
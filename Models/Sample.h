@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "Position.h"
+
+// Позиция с разметкой для обучения оценочных функций (фиксированная запись 16 байт)
+// Клетки пронумерованы только по тёмным полям: бит i * 4 + j / 2
+struct position_sample
+{
+    uint32_t white = 0; // белые фигуры
+    uint32_t black = 0; // черные фигуры
+    uint32_t kings = 0; // дамки обоих цветов
+    int16_t score = 0;  // оценка поиска: 100 * ln(отношения сил) с точки зрения белых
+    uint8_t ply = 0;    // номер полухода (чётный - ход белых)
+    int8_t result = 0;  // 1 - победа белых, 0 - ничья, -1 - победа черных
+
+    // Упаковка матрицы доски в запись
+    static position_sample from_mtx(const Position& mtx, const uint8_t ply = 0)
+    {
+        position_sample s;
+        s.ply = ply;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = (i + 1) % 2; j < 8; j += 2)
+            {
+                const uint32_t bit = uint32_t(1) << (i * 4 + j / 2);
+                if (mtx[i][j] % 2 == 1)
+                    s.white |= bit;
+                else if (mtx[i][j])
+                    s.black |= bit;
+                if (mtx[i][j] > 2)
+                    s.kings |= bit;
+            }
+        }
+        return s;
+    }
+
+    // Тип фигуры на клетке в кодировке доски (0 - пусто, 1..4 - фигуры)
+    POS_T at(const POS_T i, const POS_T j) const
+    {
+        if ((i + j) % 2 == 0)
+            return 0;
+        const uint32_t bit = uint32_t(1) << (i * 4 + j / 2);
+        if (!((white | black) & bit))
+            return 0;
+        return POS_T(((white & bit) ? 1 : 2) + ((kings & bit) ? 2 : 0));
+    }
+};
+
+static_assert(sizeof(position_sample) == 16, "position_sample must stay a 16-byte record");
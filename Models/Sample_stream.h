@@ -0,0 +1,297 @@
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Sample.h"
+
+// Файлы позиций для обучения. Два формата:
+//  - без сжатия: массив записей position_sample подряд, без заголовка (его читает nnue_trainer);
+//  - со сжатием: заголовок Magic, затем блоки до Block_records записей. Блок - число записей и размер
+//    данных (uint32), записи блока - XOR с предыдущей записью, каждая XOR-запись - 16-битная маска
+//    ненулевых байт и сами эти байты. Соседние позиции партии отличаются несколькими битами,
+//    поэтому запись сжимается примерно до 6-8 байт без внешних библиотек.
+// Заголовок не совпадает с началом несжатого файла: в первых 4 байтах там белые фигуры (не больше 12 бит),
+// а у Magic установлено 14 бит
+namespace Sample_stream
+{
+const uint32_t Magic = 0x31534B43; // "CKS1"
+const size_t Block_records = 4096;
+
+// Сжатие блока записей в out (out дополняется)
+inline void encode_block(const position_sample* rec, const size_t count, std::vector<uint8_t>& out)
+{
+    uint8_t prev[16] = {};
+    for (size_t k = 0; k < count; ++k)
+    {
+        uint8_t cur[16];
+        memcpy(cur, rec + k, 16);
+        uint16_t mask = 0;
+        uint8_t bytes[16];
+        int n = 0;
+        for (int b = 0; b < 16; ++b)
+        {
+            const uint8_t x = cur[b] ^ prev[b];
+            if (x)
+            {
+                mask |= uint16_t(1u << b);
+                bytes[n++] = x;
+            }
+        }
+        out.push_back(uint8_t(mask));
+        out.push_back(uint8_t(mask >> 8));
+        out.insert(out.end(), bytes, bytes + n);
+        memcpy(prev, cur, 16);
+    }
+}
+
+// Распаковка блока: false - данные повреждены
+inline bool decode_block(const uint8_t* data, const size_t size, const size_t count, position_sample* rec)
+{
+    uint8_t prev[16] = {};
+    size_t pos = 0;
+    for (size_t k = 0; k < count; ++k)
+    {
+        if (pos + 2 > size)
+            return false;
+        const uint16_t mask = uint16_t(data[pos] | data[pos + 1] << 8);
+        pos += 2;
+        for (int b = 0; b < 16; ++b)
+        {
+            if (mask & (1u << b))
+            {
+                if (pos >= size)
+                    return false;
+                prev[b] ^= data[pos++];
+            }
+        }
+        memcpy(rec + k, prev, 16);
+    }
+    return pos == size;
+}
+} // namespace Sample_stream
+
+// Запись позиций в файлы prefix_000.bin, prefix_001.bin, ... по shard_records записей в файле
+// (0 - один файл prefix.bin). Не потокобезопасен: партии из потоков пишутся под общей блокировкой
+class Sample_writer
+{
+public:
+    bool open(const std::string& file_prefix, const size_t records_per_shard, const bool compressed)
+    {
+        prefix = file_prefix;
+        shard_records = records_per_shard;
+        compress = compressed;
+        shard = 0;
+        return open_shard();
+    }
+
+    bool write(const position_sample* rec, size_t count)
+    {
+        while (count)
+        {
+            if (shard_records && in_shard == shard_records && !(flush_block() && open_shard()))
+                return false;
+            size_t n = count;
+            if (shard_records)
+                n = std::min(n, shard_records - in_shard);
+            if (compress)
+            {
+                const size_t room = Sample_stream::Block_records - block.size();
+                n = std::min(n, room);
+                block.insert(block.end(), rec, rec + n);
+                if (block.size() == Sample_stream::Block_records && !flush_block())
+                    return false;
+            }
+            else if (fwrite(rec, sizeof(position_sample), n, file) != n)
+                return false;
+            in_shard += n;
+            written += n;
+            rec += n;
+            count -= n;
+        }
+        return true;
+    }
+
+    bool close()
+    {
+        bool ok = flush_block();
+        if (file)
+        {
+            total_bytes += size_t(ftell(file));
+            ok = fclose(file) == 0 && ok;
+        }
+        file = nullptr;
+        return ok;
+    }
+
+    ~Sample_writer()
+    {
+        close();
+    }
+
+    size_t records() const
+    {
+        return written;
+    }
+
+    size_t bytes() const
+    {
+        return total_bytes + (file ? size_t(ftell(file)) : 0);
+    }
+
+    // Имя файла шарда
+    static std::string shard_name(const std::string& prefix, const size_t records_per_shard, const int index)
+    {
+        if (!records_per_shard)
+            return prefix + ".bin";
+        char buf[16];
+        snprintf(buf, sizeof(buf), "_%03d.bin", index);
+        return prefix + buf;
+    }
+
+private:
+    bool open_shard()
+    {
+        if (file)
+        {
+            total_bytes += size_t(ftell(file));
+            fclose(file);
+        }
+        file = fopen(shard_name(prefix, shard_records, shard++).c_str(), "wb");
+        in_shard = 0;
+        return file && (!compress || fwrite(&Sample_stream::Magic, 4, 1, file) == 1);
+    }
+
+    bool flush_block()
+    {
+        if (block.empty() || !file)
+            return true;
+        packed.clear();
+        Sample_stream::encode_block(block.data(), block.size(), packed);
+        const uint32_t header[2] = {uint32_t(block.size()), uint32_t(packed.size())};
+        const bool ok = fwrite(header, 4, 2, file) == 2 && fwrite(packed.data(), 1, packed.size(), file) == packed.size();
+        block.clear();
+        return ok;
+    }
+
+    std::string prefix;
+    size_t shard_records = 0;
+    bool compress = false;
+    int shard = 0;
+    FILE* file = nullptr;
+    size_t in_shard = 0;     // записей в текущем шарде
+    size_t written = 0;      // записей всего
+    size_t total_bytes = 0;  // байт в закрытых шардах
+    std::vector<position_sample> block;
+    std::vector<uint8_t> packed;
+};
+
+// Чтение файла позиций любого формата блоками (формат определяется по заголовку)
+class Sample_reader
+{
+public:
+    bool open(const std::string& path)
+    {
+        close();
+        file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        uint32_t magic = 0;
+        compressed = fread(&magic, 4, 1, file) == 1 && magic == Sample_stream::Magic;
+        if (!compressed)
+            fseek(file, 0, SEEK_SET);
+        return true;
+    }
+
+    // Следующие записи (до max), 0 - конец файла или ошибка (is_bad)
+    size_t read(position_sample* out, const size_t max)
+    {
+        if (!file)
+            return 0;
+        if (!compressed)
+            return fread(out, sizeof(position_sample), max, file);
+        size_t n = 0;
+        while (n < max)
+        {
+            if (pos == block.size() && !next_block())
+                break;
+            const size_t take = std::min(max - n, block.size() - pos);
+            memcpy(out + n, block.data() + pos, take * sizeof(position_sample));
+            pos += take;
+            n += take;
+        }
+        return n;
+    }
+
+    // Весь файл в data (дописывается в конец)
+    static bool load(const std::string& path, std::vector<position_sample>& data)
+    {
+        Sample_reader reader;
+        if (!reader.open(path))
+            return false;
+        const size_t Chunk = 1 << 16;
+        size_t n;
+        do
+        {
+            const size_t old = data.size();
+            data.resize(old + Chunk);
+            n = reader.read(data.data() + old, Chunk);
+            data.resize(old + n);
+        } while (n);
+        return !reader.is_bad();
+    }
+
+    bool is_bad() const
+    {
+        return bad;
+    }
+
+    void close()
+    {
+        if (file)
+            fclose(file);
+        file = nullptr;
+        block.clear();
+        pos = 0;
+        bad = false;
+    }
+
+    ~Sample_reader()
+    {
+        close();
+    }
+
+private:
+    bool next_block()
+    {
+        uint32_t header[2];
+        if (fread(header, 4, 2, file) != 2)
+            return false;
+        pos = 0;
+        // запись занимает не больше 18 байт
+        bool ok = header[0] <= Sample_stream::Block_records && header[1] <= header[0] * 18;
+        if (ok)
+        {
+            packed.resize(header[1]);
+            block.resize(header[0]);
+            ok = fread(packed.data(), 1, packed.size(), file) == packed.size() &&
+                 Sample_stream::decode_block(packed.data(), packed.size(), block.size(), block.data());
+        }
+        if (!ok)
+        {
+            bad = true;
+            block.clear();
+            return false;
+        }
+        return true;
+    }
+
+    FILE* file = nullptr;
+    bool compressed = false;
+    bool bad = false;
+    std::vector<position_sample> block;
+    std::vector<uint8_t> packed;
+    size_t pos = 0;
+};
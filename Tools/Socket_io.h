@@ -0,0 +1,67 @@
+#pragma once
+// Построчный обмен через локальный (Unix) сокет для game_service и load_client
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Чтение строк из сокета с буфером
+class Line_reader
+{
+public:
+    explicit Line_reader(const int fd) : fd(fd)
+    {
+    }
+
+    // false - соединение закрыто
+    bool read_line(string& line)
+    {
+        while (true)
+        {
+            const size_t end = buffer.find('\n');
+            if (end != string::npos)
+            {
+                line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                return true;
+            }
+            char chunk[4096];
+            const ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n <= 0)
+                return false;
+            buffer.append(chunk, size_t(n));
+        }
+    }
+
+private:
+    int fd;
+    string buffer;
+};
+
+// Запись строки целиком (без SIGPIPE при закрытом соединении)
+inline bool write_line(const int fd, const string& line)
+{
+    const string data = line + "\n";
+    size_t done = 0;
+    while (done < data.size())
+    {
+        const ssize_t n = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        done += size_t(n);
+    }
+    return true;
+}
+
+inline sockaddr_un socket_address(const string& path)
+{
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    return addr;
+}
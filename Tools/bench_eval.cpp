@@ -0,0 +1,171 @@
+// Бенчмарк оценки листьев: поштучная оценка матриц (как Logic::calc_score) против пакетной Batch_eval.
+// Сборка: g++ -std=c++17 -O2 -mavx2 Tools/bench_eval.cpp -o bench_eval
+// Запуск: bench_eval [количество родительских позиций]
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "../Engine/Batch_eval.h"
+
+typedef Position Matrix;
+
+// Поштучная оценка - тот же алгоритм, что в Logic::calc_score
+static double calc_score(const Matrix& mtx, const bool potential, const bool first_bot_color)
+{
+    double w = 0, wq = 0, b = 0, bq = 0;
+    int w_pot = 0, b_pot = 0;
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        for (POS_T j = 0; j < 8; ++j)
+        {
+            w += (mtx[i][j] == 1);
+            wq += (mtx[i][j] == 3);
+            b += (mtx[i][j] == 2);
+            bq += (mtx[i][j] == 4);
+            w_pot += (mtx[i][j] == 1) * (7 - i);
+            b_pot += (mtx[i][j] == 2) * (i);
+        }
+    }
+    if (potential)
+    {
+        w += 0.05 * w_pot;
+        b += 0.05 * b_pot;
+    }
+    if (!first_bot_color)
+    {
+        swap(b, w);
+        swap(bq, wq);
+    }
+    if (w + wq == 0)
+        return 1e9;
+    if (b + bq == 0)
+        return 0;
+    const int q_coef = potential ? 5 : 4;
+    return (b + bq * q_coef) / (w + wq * q_coef);
+}
+
+// Копия доски с выполненным ходом (как Logic::make_turn)
+static Matrix make_turn(Matrix mtx, const move_pos& turn)
+{
+    if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
+        mtx[turn.x][turn.y] += 2;
+    mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
+    mtx[turn.x][turn.y] = 0;
+    return mtx;
+}
+
+// Тихие ходы белых: листья, которые поиск оценивает на последнем уровне
+static vector<move_pos> quiet_turns(const Matrix& mtx)
+{
+    vector<move_pos> res;
+    for (POS_T x = 0; x < 8; ++x)
+    {
+        for (POS_T y = 0; y < 8; ++y)
+        {
+            if (mtx[x][y] == 1)
+            {
+                for (POS_T j = y - 1; j <= y + 1; j += 2)
+                    if (x > 0 && j >= 0 && j < 8 && !mtx[x - 1][j])
+                        res.emplace_back(x, y, x - 1, j);
+            }
+            else if (mtx[x][y] == 3)
+            {
+                for (POS_T i = -1; i <= 1; i += 2)
+                    for (POS_T j = -1; j <= 1; j += 2)
+                        for (POS_T i2 = x + i, j2 = y + j; i2 >= 0 && i2 < 8 && j2 >= 0 && j2 < 8 && !mtx[i2][j2];
+                             i2 += i, j2 += j)
+                            res.emplace_back(x, y, i2, j2);
+            }
+        }
+    }
+    return res;
+}
+
+// Случайная позиция: kings - доля дамок среди фигур
+static Matrix random_position(mt19937& rng, const int pieces, const double kings)
+{
+    Matrix mtx;
+    uniform_real_distribution<double> u(0, 1);
+    for (int k = 0; k < pieces;)
+    {
+        const POS_T i = POS_T(rng() % 8), j = POS_T(rng() % 8);
+        if ((i + j) % 2 == 0 || mtx[i][j])
+            continue;
+        POS_T type = POS_T(1 + k % 2 + (u(rng) < kings ? 2 : 0));
+        if ((type == 1 && i == 0) || (type == 2 && i == 7))
+            type += 2;
+        mtx[i][j] = type;
+        ++k;
+    }
+    return mtx;
+}
+
+static void run(const char* name, const vector<Matrix>& parents, const bool potential)
+{
+    vector<vector<move_pos>> children;
+    size_t leaves = 0;
+    for (auto& p : parents)
+    {
+        children.push_back(quiet_turns(p));
+        leaves += children.back().size();
+    }
+
+    Batch_eval batch;
+    double sum_scalar = 0, sum_kernel = 0, sum_batch = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (size_t p = 0; p < parents.size(); ++p)
+        for (auto& turn : children[p])
+            sum_scalar += calc_score(make_turn(parents[p], turn), potential, false);
+    auto t1 = chrono::steady_clock::now();
+    for (size_t p = 0; p < parents.size(); ++p)
+    {
+        batch.clear(parents[p]);
+        for (auto& turn : children[p])
+            batch.add(turn);
+        batch.evaluate_scalar(potential, false);
+        for (int k = 0; k < batch.size(); ++k)
+            sum_kernel += batch.score[k];
+    }
+    auto t2 = chrono::steady_clock::now();
+    for (size_t p = 0; p < parents.size(); ++p)
+    {
+        batch.clear(parents[p]);
+        for (auto& turn : children[p])
+            batch.add(turn);
+        batch.evaluate(potential, false);
+        for (int k = 0; k < batch.size(); ++k)
+            sum_batch += batch.score[k];
+    }
+    auto t3 = chrono::steady_clock::now();
+
+    auto rate = [&](chrono::steady_clock::duration d) {
+        return leaves / chrono::duration<double>(d).count() / 1e6;
+    };
+    printf("%-22s %9zu leaves | per-leaf %7.1f M/s | batch scalar %7.1f M/s | batch simd %7.1f M/s | x%.1f%s\n", name,
+           leaves, rate(t1 - t0), rate(t2 - t1), rate(t3 - t2),
+           chrono::duration<double>(t1 - t0).count() / chrono::duration<double>(t3 - t2).count(),
+           (abs(sum_scalar - sum_batch) < 1e-6 * leaves && abs(sum_kernel - sum_batch) < 1e-6 * leaves) ? ""
+                                                                                                         : " MISMATCH");
+}
+
+int main(int argc, char* argv[])
+{
+    const int count = argc > 1 ? atoi(argv[1]) : 20000;
+    mt19937 rng(42);
+    vector<Matrix> middlegame, endgame;
+    for (int k = 0; k < count; ++k)
+    {
+        middlegame.push_back(random_position(rng, 16, 0.1));
+        endgame.push_back(random_position(rng, 8, 0.9));
+    }
+#if defined(__AVX2__)
+    printf("kernels: AVX2\n");
+#else
+    printf("kernels: scalar (build with -mavx2 for SIMD)\n");
+#endif
+    run("middlegame, material", middlegame, false);
+    run("middlegame, potential", middlegame, true);
+    run("king endgame, material", endgame, false);
+    run("king endgame, potential", endgame, true);
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Бенчмарк поиска с аппаратными счётчиками: поиск на фиксированную глубину в наборе позиций из партии
+// бота против самого себя. Для каждой позиции и в сумме печатает узлы, время и счётчики процессора
+// (такты, инструкции, промахи кэша, ошибки предсказания переходов, IPC и их стоимость на узел),
+// чтобы видеть влияние раскладки данных и выделений памяти. Без доступа к счётчикам печатаются
+// только узлы и время.
+// С --check-batch 1 вместо замера сверяет пакетную оценку листьев с поштучной на глубинах 1..D: в тех же
+// позициях и в позиции, где тихий ход дамки на последнем полуходе повторяет позицию партии (ничья),
+// оценки и ходы должны совпасть; при расхождении код возврата 1.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/bench_search.cpp -o bench_search
+// Запуск: bench_search [--depth D] [--positions N] [--hash MB] [--scoring NumberAndPotential] [--optimization O1]
+//                      [--check-batch 1]
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "../Engine/Engine.h"
+#include "../Engine/Perf_counters.h"
+
+// Позиция fen, затем ходы moves; false - ход недопустим
+static bool set_line(Engine& engine, const string& fen, const vector<string>& moves)
+{
+    engine.set_position(fen);
+    for (auto& m : moves)
+        if (!engine.play(m))
+            return false;
+    return true;
+}
+
+// Сверка пакетной и поштучной оценки листьев: число расхождений
+static int check_batch(const Bot_options& options, const vector<string>& fens, const int depth)
+{
+    // дамки ходят туда и обратно; на глубине 2 ответ черной дамки на листе повторяет позицию партии
+    vector<pair<string, vector<string>>> lines = {{"W:WK30,13:BK2,K3,8", {"30-23", "2-11", "23-30", "3-14"}}};
+    for (auto& fen : fens)
+        lines.push_back({fen, {}});
+    Bot_options per_leaf = options;
+    per_leaf.batch_leaves = false;
+    int mismatches = 0;
+    for (auto& line : lines)
+    {
+        // новые движки на каждую позицию: порядок ходов без случайности зависит от числа прошлых поисков
+        Engine batch(options), single(per_leaf);
+        if (!set_line(batch, line.first, line.second) || !set_line(single, line.first, line.second))
+        {
+            printf("bad line from %s\n", line.first.c_str());
+            return mismatches + 1;
+        }
+        for (int d = 1; d <= depth; ++d)
+        {
+            Search_limits limits;
+            limits.depth = d;
+            const auto a = batch.search(limits), b = single.search(limits);
+            if (a.score == b.score && a.turn == b.turn)
+                continue;
+            ++mismatches;
+            printf("%s depth %d: batch %s %.6g, per leaf %s %.6g\n", batch.position().c_str(), d,
+                   Engine::move_to_string(a.turn).c_str(), a.score, Engine::move_to_string(b.turn).c_str(), b.score);
+        }
+    }
+    printf("batch check: %zu positions, depths 1..%d, %d mismatches\n", lines.size(), depth, mismatches);
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    int depth = 6, positions = 20;
+    size_t hash_mb = 0;
+    bool batch_check = false;
+    Bot_options options;
+    for (int k = 1; k + 1 < argc; k += 2)
+    {
+        if (!strcmp(argv[k], "--depth"))
+            depth = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--positions"))
+            positions = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--hash"))
+            hash_mb = size_t(atoll(argv[k + 1]));
+        else if (!strcmp(argv[k], "--scoring"))
+            options.scoring = Bot_options::parse_scoring(argv[k + 1]);
+        else if (!strcmp(argv[k], "--optimization"))
+            options.optimization = Bot_options::parse_optimization(argv[k + 1]);
+        else if (!strcmp(argv[k], "--check-batch"))
+            batch_check = atoi(argv[k + 1]) != 0;
+    }
+
+    // Позиции - партия движка с самим собой на глубине 4 (одинаковая от запуска к запуску)
+    vector<string> fens;
+    {
+        Engine game(options);
+        Search_limits limits;
+        limits.depth = 4;
+        for (int k = 0; k < positions && !game.legal_moves().empty(); ++k)
+        {
+            fens.push_back(game.position());
+            game.play(game.search(limits).turn);
+        }
+    }
+
+    if (batch_check)
+        return check_batch(options, fens, depth) ? 1 : 0;
+
+    Perf_counters perf;
+    if (!perf.open())
+        printf("hardware counters unavailable: %s\n", perf.error().c_str());
+
+    Engine engine(options);
+    if (hash_mb)
+        engine.set_hash_size(hash_mb << 20);
+    Perf_counters::Sample total;
+    int64_t total_nodes = 0, total_ms = 0;
+    for (size_t k = 0; k < fens.size(); ++k)
+    {
+        engine.set_position(fens[k]);
+        Search_limits limits;
+        limits.depth = depth;
+        perf.start();
+        const auto res = engine.search(limits);
+        const auto sample = perf.stop();
+        total_nodes += res.nodes;
+        total_ms += res.time_ms;
+        for (int c = 0; c < Perf_counters::Count; ++c)
+        {
+            total.value[c] += sample.value[c];
+            total.valid[c] = sample.valid[c];
+        }
+        printf("%2zu %-40s nodes %9lld %6lld ms", k + 1, fens[k].c_str(), (long long)res.nodes,
+               (long long)res.time_ms);
+        if (perf.is_open())
+            printf("  %s", sample.format(res.nodes).c_str());
+        printf("\n");
+    }
+    printf("total: nodes %lld, %lld ms, %.0f nodes/sec\n", (long long)total_nodes, (long long)total_ms,
+           total_ms ? total_nodes * 1000.0 / total_ms : 0.0);
+    if (perf.is_open())
+        printf("counters: %s\n", total.format(total_nodes).c_str());
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Матч двух методов поиска: MCTS против перебора с одинаковым временем на ход.
+// Печатает счёт и задержку хода (среднюю и максимальную) каждой стороны.
+// С --openings партии начинаются с позиций набора дебютов (Tools/opening_suite.cpp): каждая позиция
+// играется дважды со сменой цветов, по кругу, если партий больше удвоенного числа позиций.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/bot_match.cpp -o bot_match
+// Запуск: bot_match [--games N] [--movetime MS] [--threads T] [--max-turns N] [--openings suite.txt]
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "../Engine/Engine.h"
+
+struct Side_stats
+{
+    int64_t moves = 0, total_ms = 0, max_ms = 0;
+};
+
+int main(int argc, char** argv)
+{
+    int games = 10, threads = 0, max_turns = 120;
+    int64_t movetime = 200;
+    string openings_path;
+    for (int k = 1; k + 1 < argc; k += 2)
+    {
+        if (!strcmp(argv[k], "--games"))
+            games = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--movetime"))
+            movetime = atoll(argv[k + 1]);
+        else if (!strcmp(argv[k], "--threads"))
+            threads = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--max-turns"))
+            max_turns = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--openings"))
+            openings_path = argv[k + 1];
+    }
+    vector<string> openings; // FEN начальных позиций (первое слово строки набора)
+    if (!openings_path.empty())
+    {
+        ifstream fin(openings_path);
+        string line, fen;
+        while (getline(fin, line))
+            if (stringstream(line) >> fen)
+                openings.push_back(fen);
+        if (openings.empty())
+        {
+            printf("no openings in %s\n", openings_path.c_str());
+            return 1;
+        }
+    }
+    Bot_options alpha_beta, mcts;
+    mcts.search = Search_method::MCTS;
+    mcts.mcts_threads = threads;
+    int wins = 0, losses = 0, draws = 0; // с точки зрения MCTS
+    Side_stats stats[2];                 // 0 - перебор, 1 - MCTS
+    for (int g = 0; g < games; ++g)
+    {
+        // MCTS играет белыми в чётных партиях, пара партий начинается с одного дебюта
+        Engine engines[2] = {Engine(alpha_beta), Engine(mcts)};
+        Engine board;
+        const bool mcts_color = g % 2;
+        if (!openings.empty() && !board.set_position(openings[(g / 2) % openings.size()]))
+        {
+            printf("bad opening %s\n", openings[(g / 2) % openings.size()].c_str());
+            return 1;
+        }
+        int turn = 0;
+        for (; turn < max_turns && !board.legal_moves().empty(); ++turn)
+        {
+            const int side = (board.side_to_move() == mcts_color) ? 1 : 0;
+            Engine& e = engines[side];
+            e.set_position(board.position());
+            Search_limits limits;
+            limits.time_ms = movetime;
+            const auto res = e.search(limits);
+            stats[side].moves++;
+            stats[side].total_ms += res.time_ms;
+            stats[side].max_ms = max(stats[side].max_ms, res.time_ms);
+            board.play(res.turn);
+        }
+        // ходов нет у ходящего - он проиграл
+        const bool mcts_lost = board.side_to_move() == mcts_color;
+        if (turn == max_turns)
+            ++draws;
+        else if (mcts_lost)
+            ++losses;
+        else
+            ++wins;
+        printf("game %d: %s\n", g + 1, turn == max_turns ? "draw" : (mcts_lost ? "alpha-beta wins" : "MCTS wins"));
+    }
+    printf("MCTS +%d =%d -%d against alpha-beta, movetime %lld ms\n", wins, draws, losses, (long long)movetime);
+    const char* names[2] = {"alpha-beta", "MCTS"};
+    for (int side = 0; side < 2; ++side)
+        printf("%s: %lld moves, avg %.1f ms, max %lld ms\n", names[side], (long long)stats[side].moves,
+               stats[side].moves ? double(stats[side].total_ms) / stats[side].moves : 0.0,
+               (long long)stats[side].max_ms);
+    return 0;
+}
@@ -0,0 +1,391 @@
+// Движок для внешних менеджеров партий: текстовый протокол в стиле UCI через stdin/stdout.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/engine_server.cpp -o checkers_engine
+//
+// Команды:
+//   uci | isready | ucinewgame | quit
+//   setoption name <Variant|Search|Scoring|Optimization|NNUEPath|NTuplePath|NoRandom|SharedMemory|Hash|SharedHash> value <значение>
+//   position startpos [moves 22-18 11x22 ...]
+//   position fen W:W21-32:B1-12 [moves ...]
+//   go [depth N] [movetime MS] [nodes N] [infinite] [ponder]
+//   stop | ponderhit
+// Ответы: info depth D score cp S nodes N nps N time MS pv <ходы>, bestmove <ход> | bestmove none
+// (score win N | score loss N - исход партии через N полуходов); nps 0, пока time 0.
+// pv - главная вариация: у основного движка лучший ход и продолжение из таблицы перестановок
+// (без таблицы, Hash 0, - только лучший ход), у вариантов - линия, собранная перебором.
+// go ponder без movetime после ponderhit ищет до depth/nodes или до stop, как go infinite.
+// Search: AlphaBeta - перебор с итеративным углублением, MCTS - поиск Монте-Карло на все ядра с тем же
+// бюджетом movetime/nodes (nodes - число розыгрышей).
+// SharedMemory - сеть NNUE в общей памяти, SharedHash - таблица перестановок в общей памяти /checkers-hash
+// (размер в МБ, одинаковый у всех процессов), Hash - своя таблица процесса в МБ.
+// Variant: russian - основной движок Engine, english и international - Variant_engine (доска 10x10
+// для international, клетки 1-50); остальные настройки относятся только к основному движку
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../Engine/Engine.h"
+#include "../Engine/Variant_engine.h"
+
+class Engine_server
+{
+public:
+    Engine_server()
+    {
+        create_engine();
+    }
+
+    ~Engine_server()
+    {
+        stop_search();
+    }
+
+    // Главный цикл чтения команд
+    void run()
+    {
+        string line;
+        while (getline(cin, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            stringstream ss(line);
+            string cmd;
+            ss >> cmd;
+            if (cmd == "uci")
+            {
+                send("id name Checkers");
+                send("option name Variant type combo default russian var russian var english var international");
+                send("option name Search type combo default AlphaBeta var AlphaBeta var MCTS");
+                send("option name Scoring type combo default NumberAndPotential var NumberOnly var NumberAndPotential "
+                     "var NNUE var NTuple");
+                send("option name Optimization type combo default O1 var O0 var O1 var O2");
+                send("option name NNUEPath type string default <empty>");
+                send("option name NTuplePath type string default <empty>");
+                send("option name NoRandom type check default true");
+                send("option name SharedMemory type check default false");
+                send("option name Hash type spin default 16 min 0 max 65536");
+                send("option name SharedHash type spin default 0 min 0 max 65536");
+                send("uciok");
+            }
+            else if (cmd == "isready")
+                send("readyok");
+            else if (cmd == "setoption")
+                set_option(ss);
+            else if (cmd == "ucinewgame")
+            {
+                stop_search();
+                set_start_position();
+                position_fen.clear();
+                position_moves.clear();
+            }
+            else if (cmd == "position")
+                set_position(ss);
+            else if (cmd == "go")
+                go(ss);
+            else if (cmd == "stop")
+                stop_search();
+            else if (cmd == "ponderhit")
+                ponder_hit();
+            else if (cmd == "quit")
+                break;
+            else if (!cmd.empty())
+                send("info string unknown command " + cmd);
+        }
+    }
+
+private:
+    void send(const string& text)
+    {
+        lock_guard<mutex> lock(out_mutex);
+        cout << text << endl;
+    }
+
+    void set_option(stringstream& ss)
+    {
+        string word, name, value;
+        ss >> word >> name >> word;
+        getline(ss >> ws, value);
+        stop_search();
+        if (name == "Variant")
+        {
+            auto next = make_variant_engine(value);
+            if (!next)
+            {
+                send("info string unknown variant " + value);
+                return;
+            }
+            // другие правила - партия начинается заново
+            variant_name = value;
+            variant = value != Russian_rules::Name ? move(next) : nullptr;
+            engine->set_start_position();
+            position_fen.clear();
+            position_moves.clear();
+            return;
+        }
+        if (name == "Search")
+            options.search = Bot_options::parse_search(value);
+        else if (name == "Scoring")
+            options.scoring = Bot_options::parse_scoring(value);
+        else if (name == "Optimization")
+            options.optimization = Bot_options::parse_optimization(value);
+        else if (name == "NNUEPath")
+            options.nnue_path = value;
+        else if (name == "NTuplePath")
+            options.ntuple_path = value;
+        else if (name == "NoRandom")
+            options.no_random = (value == "true");
+        else if (name == "SharedMemory")
+            options.shared_memory = (value == "true");
+        else if (name == "Hash")
+            hash_mb = atoi(value.c_str());
+        else if (name == "SharedHash")
+            shared_hash_mb = atoi(value.c_str());
+        else
+        {
+            send("info string unknown option " + name);
+            return;
+        }
+        // новые настройки - новый экземпляр основного движка; движок варианта их не использует и остаётся
+        create_engine();
+        if (!variant)
+            restore_position();
+    }
+
+    void create_engine()
+    {
+        engine = make_unique<Engine>(options);
+        engine->set_hash_size(size_t(hash_mb) << 20);
+        if (shared_hash_mb && !engine->set_shared_hash("/checkers-hash", size_t(shared_hash_mb) << 20))
+            send("info string shared hash unavailable, using Hash");
+    }
+
+    // Позиция последней команды position заново - FEN и все ходы после него, чтобы новый движок
+    // знал историю партии (повторения позиций)
+    void restore_position()
+    {
+        if (position_fen.empty())
+            set_start_position();
+        else
+            set_fen(position_fen);
+        for (auto& move : position_moves)
+            play(move);
+    }
+
+    // Операции с позицией у выбранного движка
+    void set_start_position()
+    {
+        if (variant)
+            variant->set_start_position();
+        else
+            engine->set_start_position();
+    }
+
+    bool set_fen(const string& fen)
+    {
+        return variant ? variant->set_position(fen) : engine->set_position(fen);
+    }
+
+    bool play(const string& move)
+    {
+        return variant ? variant->play(move) : engine->play(move);
+    }
+
+    void set_position(stringstream& ss)
+    {
+        stop_search();
+        string word;
+        ss >> word;
+        if (word == "startpos")
+        {
+            set_start_position();
+            position_fen.clear();
+        }
+        else if (word == "fen")
+        {
+            string fen;
+            ss >> fen;
+            if (!set_fen(fen))
+            {
+                send("info string bad fen " + fen);
+                return;
+            }
+            position_fen = fen;
+        }
+        position_moves.clear();
+        if (ss >> word && word == "moves")
+        {
+            while (ss >> word)
+            {
+                if (!play(word))
+                {
+                    send("info string illegal move " + word);
+                    return;
+                }
+                position_moves.push_back(word);
+            }
+        }
+    }
+
+    void go(stringstream& ss)
+    {
+        stop_search();
+        Search_limits limits;
+        int64_t movetime = 0;
+        bool ponder = false;
+        string word;
+        while (ss >> word)
+        {
+            if (word == "depth")
+                ss >> limits.depth;
+            else if (word == "movetime")
+                ss >> movetime;
+            else if (word == "nodes")
+                ss >> limits.nodes;
+            else if (word == "ponder")
+                ponder = true;
+        }
+        // при обдумывании на ходу соперника время начинает идти только после ponderhit
+        limits.time_ms = ponder ? 0 : movetime;
+        ponder_time = movetime;
+        pondering = ponder;
+        result_ready = false;
+        // флаг остановки сбрасывается здесь, а не в потоке поиска: stop сразу после go не теряется
+        if (variant)
+            variant->clear_stop();
+        else
+            engine->clear_stop();
+        searcher = thread([this, limits]() {
+            string best;
+            if (variant)
+                best = variant->search(limits, [this](const Variant_result& r) { send_info(r); }).move;
+            else
+                best = Engine::move_to_string(
+                    engine->search(limits, [this](const Search_result& r) { send_info(r); }).turn);
+            lock_guard<mutex> lock(state_mutex);
+            result = best;
+            result_ready = true;
+            // во время обдумывания bestmove отправляется только после ponderhit или stop
+            if (!pondering)
+                send_best();
+        });
+    }
+
+    void ponder_hit()
+    {
+        lock_guard<mutex> lock(state_mutex);
+        if (!pondering)
+            return;
+        pondering = false;
+        if (result_ready)
+        {
+            send_best();
+            return;
+        }
+        if (ponder_time > 0)
+        {
+            // отсчёт времени хода начинается с ponderhit
+            timer = thread([this, deadline = chrono::steady_clock::now() + chrono::milliseconds(ponder_time)]() {
+                while (chrono::steady_clock::now() < deadline)
+                {
+                    {
+                        lock_guard<mutex> lock(state_mutex);
+                        if (result_ready)
+                            return;
+                    }
+                    this_thread::sleep_for(chrono::milliseconds(1));
+                }
+                stop_engine();
+            });
+        }
+    }
+
+    // Остановка текущего поиска с отправкой bestmove
+    void stop_search()
+    {
+        {
+            lock_guard<mutex> lock(state_mutex);
+            if (pondering)
+            {
+                pondering = false;
+                if (result_ready)
+                    send_best();
+            }
+        }
+        stop_engine();
+        if (searcher.joinable())
+            searcher.join();
+        if (timer.joinable())
+            timer.join();
+    }
+
+    void stop_engine()
+    {
+        if (variant)
+            variant->stop();
+        else
+            engine->stop();
+    }
+
+    void send_info(const Search_result& r)
+    {
+        string pv;
+        for (auto& turn : r.pv)
+            pv += (pv.empty() ? "" : " ") + Engine::move_to_string(turn);
+        send_info(r.depth, score_to_string(r.score), r.nodes, r.time_ms, pv);
+    }
+
+    void send_info(const Variant_result& r)
+    {
+        string score = "cp " + to_string(r.score);
+        if (abs(r.score) >= Variant_win - Variant_search<Russian_rules>::Max_ply)
+            score = (r.score > 0 ? "win " : "loss ") + to_string(Variant_win - abs(r.score));
+        send_info(r.depth, score, r.nodes, r.time_ms, r.pv);
+    }
+
+    void send_info(const int depth, const string& score, const int64_t nodes, const int64_t time_ms,
+                   const string& pv)
+    {
+        const int64_t nps = time_ms ? nodes * 1000 / time_ms : 0;
+        send("info depth " + to_string(depth) + " score " + score + " nodes " + to_string(nodes) + " nps " +
+             to_string(nps) + " time " + to_string(time_ms) + " pv " + pv);
+    }
+
+    // Вызывается под state_mutex
+    void send_best()
+    {
+        send("bestmove " + (result.empty() ? string("none") : result));
+    }
+
+    // Оценка в сотых долях ln(отношения сил), как в position_sample::score
+    static string score_to_string(const double score)
+    {
+        if (is_win(score))
+            return "win " + to_string(plies_to_end(score));
+        if (is_loss(score))
+            return "loss " + to_string(plies_to_end(score));
+        return "cp " + to_string(lround(100 * log(score)));
+    }
+
+    Bot_options options;
+    unique_ptr<Engine> engine;
+    unique_ptr<Variant_engine_base> variant;
+    string variant_name = Russian_rules::Name;
+    thread searcher, timer;
+    mutex out_mutex, state_mutex;
+    string result; // лучший ход последнего поиска
+    bool result_ready = false;
+    bool pondering = false;
+    int64_t ponder_time = 0;
+    string position_fen;           // FEN последней команды position (пусто - startpos)
+    vector<string> position_moves; // её ходы, сыгранные без ошибки
+    int hash_mb = 16, shared_hash_mb = 0;
+};
+
+int main()
+{
+    ios::sync_with_stdio(false);
+    Engine_server server;
+    server.run();
+    return 0;
+}
@@ -0,0 +1,300 @@
+// База партий (Engine/Game_db.h): сборка из PDN, запрос позиции, замер скорости запросов и дебютная книга,
+// а также разбор партий из PDN (Engine/Game_analysis.h).
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/game_db.cpp -o game_db
+// Запуск: game_db build <prefix> <games.pdn>... [--threads T]
+//         game_db query <prefix> <FEN|startpos> [--games N]
+//         game_db bench <prefix> [--queries N]
+//         game_db book <prefix> <book.txt> [--min-games N] [--plies P]
+//         game_db analyze <games.pdn> [--games N] [--depth D] [--threads T]
+// build читает PDN-файлы параллельно (по потоку на файл) и собирает prefix.cgd и prefix.cgi;
+// query печатает итоги партий через позицию, продолжения и первые N партий; bench запрашивает
+// случайные позиции из индекса и печатает p50/p99/max; book обходит продолжения от начальной
+// расстановки, сыгранные не меньше чем в N партиях, и пишет строки "FEN ход партий очков%"
+// (очки ходящего: выигрыш 1, ничья 1/2, партии без результата не учитываются); analyze разбирает первые
+// N партий файла и печатает ошибки, упущенные выигрыши и время разбора каждой партии.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <random>
+#include <set>
+#include <sstream>
+
+#include "../Engine/Game_analysis.h"
+#include "../Engine/Game_db.h"
+
+struct Options
+{
+    int threads = 0;
+    size_t games = 10;
+    size_t queries = 100000;
+    uint32_t min_games = 10;
+    int plies = 12;
+    int depth = 8;
+};
+
+static double percent(const uint32_t part, const uint32_t total)
+{
+    return total ? 100.0 * part / total : 0.0;
+}
+
+static int build(const string& prefix, const vector<string>& inputs, const Options& opt)
+{
+    const auto start = chrono::steady_clock::now();
+    vector<future<pair<bool, vector<Game_record>>>> reads;
+    for (auto& path : inputs)
+        reads.push_back(async(launch::async, [path]() {
+            ifstream fin(path, ios::binary);
+            stringstream text;
+            text << fin.rdbuf();
+            vector<Game_record> games;
+            Game_db::read_pdn(text.str(), games);
+            return make_pair(bool(fin), std::move(games));
+        }));
+    vector<Game_record> games;
+    for (size_t k = 0; k < reads.size(); ++k)
+    {
+        auto res = reads[k].get();
+        if (!res.first)
+        {
+            printf("can't read %s\n", inputs[k].c_str());
+            return 1;
+        }
+        games.insert(games.end(), make_move_iterator(res.second.begin()), make_move_iterator(res.second.end()));
+    }
+    const auto read_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+    Game_db::Build_stats stats;
+    string error;
+    if (!Game_db::build(prefix, games, opt.threads, stats, error))
+    {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    printf("games %zu (%zu with an illegal move), positions %zu, index records %zu, read %lld ms, build %lld ms\n",
+           stats.games, stats.bad_games, stats.positions, stats.records, (long long)read_ms, (long long)stats.ms);
+    return 0;
+}
+
+static int query(const string& prefix, const string& fen, const Options& opt)
+{
+    Game_db db;
+    if (!db.open(prefix))
+    {
+        printf("can't open %s\n", prefix.c_str());
+        return 1;
+    }
+    Engine engine;
+    if (fen != "startpos" && !engine.set_position(fen))
+    {
+        printf("bad position %s\n", fen.c_str());
+        return 1;
+    }
+    const uint64_t key = Zobrist::hash(engine.board(), engine.side_to_move());
+    const auto start = chrono::steady_clock::now();
+    const auto stats = db.query(key);
+    const auto us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    printf("%u games: white %.1f%%, draw %.1f%%, black %.1f%% (query %.1f us)\n", stats.games,
+           percent(stats.white_wins, stats.games), percent(stats.draws, stats.games),
+           percent(stats.black_wins, stats.games), us);
+    for (auto& c : stats.moves)
+        printf("  %-8s %8u  white %5.1f%%  draw %5.1f%%  black %5.1f%%\n", c.move.empty() ? "(end)" : c.move.c_str(),
+               c.games, percent(c.white_wins, c.games), percent(c.draws, c.games), percent(c.black_wins, c.games));
+    for (auto id : db.games_with(key, opt.games))
+    {
+        const auto game = db.game(id);
+        printf("game %u: %s, %zu plies:", id, Game_db::result_string(game.result).c_str(), game.moves.size());
+        for (size_t k = 0; k < min<size_t>(game.moves.size(), 12); ++k)
+            printf(" %s", game.moves[k].c_str());
+        printf("%s\n", game.moves.size() > 12 ? " ..." : "");
+    }
+    return 0;
+}
+
+static int bench(const string& prefix, const Options& opt)
+{
+    Game_db db;
+    if (!db.open(prefix) || !db.record_count())
+    {
+        printf("can't open %s or it is empty\n", prefix.c_str());
+        return 1;
+    }
+    mt19937_64 rng(1);
+    vector<uint64_t> keys(opt.queries);
+    for (auto& key : keys)
+        key = db.key_at(rng() % db.record_count());
+    vector<double> us;
+    us.reserve(keys.size());
+    uint64_t games = 0;
+    for (auto key : keys)
+    {
+        const auto start = chrono::steady_clock::now();
+        games += db.query(key).games;
+        us.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+    }
+    sort(us.begin(), us.end());
+    printf("%zu games, %zu index records, %zu queries: p50 %.2f us, p99 %.2f us, max %.2f us (%.1f games/query)\n",
+           db.game_count(), db.record_count(), us.size(), us[us.size() / 2], us[us.size() * 99 / 100], us.back(),
+           double(games) / us.size());
+    return 0;
+}
+
+// Обход продолжений в глубину; повторные позиции (перестановки ходов) не раскрываются
+static void book_walk(const Game_db& db, Engine& engine, const Options& opt, const int ply, set<uint64_t>& seen,
+                      ofstream& out, size_t& lines)
+{
+    const uint64_t key = Zobrist::hash(engine.board(), engine.side_to_move());
+    if (ply >= opt.plies || !seen.insert(key).second)
+        return;
+    const string fen = engine.position();
+    for (auto& c : db.query(key).moves)
+    {
+        if (c.move.empty() || c.games < opt.min_games)
+            continue;
+        const uint32_t decided = c.white_wins + c.black_wins + c.draws;
+        const uint32_t wins = engine.side_to_move() ? c.black_wins : c.white_wins;
+        out << fen << " " << c.move << " " << c.games << " "
+            << lround(decided ? 100.0 * (wins + c.draws * 0.5) / decided : 50.0) << "%\n";
+        ++lines;
+        const auto moves = engine.legal_moves();
+        const int k = Game_db::match_move(moves, c.move);
+        if (k < 0)
+            continue;
+        engine.play(moves[k]);
+        book_walk(db, engine, opt, ply + 1, seen, out, lines);
+        engine.set_position(fen);
+    }
+}
+
+static int book(const string& prefix, const string& out_path, const Options& opt)
+{
+    Game_db db;
+    if (!db.open(prefix))
+    {
+        printf("can't open %s\n", prefix.c_str());
+        return 1;
+    }
+    ofstream out(out_path, ios::trunc);
+    if (!out)
+    {
+        printf("can't write %s\n", out_path.c_str());
+        return 1;
+    }
+    Engine engine;
+    set<uint64_t> seen;
+    size_t lines = 0;
+    book_walk(db, engine, opt, 0, seen, out, lines);
+    printf("book: %zu moves from %zu positions\n", lines, seen.size());
+    return out ? 0 : 1;
+}
+
+// Оценка хода: ln(отношения сил) или исход через N полуходов
+static string score_text(const double score)
+{
+    if (is_win(score))
+        return "win " + to_string(plies_to_end(score));
+    if (is_loss(score))
+        return "loss " + to_string(plies_to_end(score));
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%+.2f", log(score));
+    return buf;
+}
+
+static int analyze(const string& path, const Options& opt)
+{
+    ifstream fin(path, ios::binary);
+    stringstream text;
+    text << fin.rdbuf();
+    vector<Game_record> games;
+    Game_db::read_pdn(text.str(), games);
+    if (!fin || games.empty())
+    {
+        printf("can't read games from %s\n", path.c_str());
+        return 1;
+    }
+    Analysis_options analysis;
+    analysis.depth = opt.depth;
+    analysis.threads = opt.threads;
+    Engine engine;
+    for (size_t g = 0; g < min(games.size(), opt.games); ++g)
+    {
+        vector<Position> positions;
+        bool first_color = false;
+        Game_db::replay(engine, games[g], [&](const Position& mtx, const bool color,
+                                              const vector<move_pos>*) {
+            if (positions.empty())
+                first_color = color;
+            positions.push_back(mtx);
+        });
+        const auto start = chrono::steady_clock::now();
+        const auto moves = Game_analysis::analyze(positions, first_color, analysis);
+        const auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        int marks[3] = {};
+        for (auto& a : moves)
+            ++marks[a.kind];
+        printf("game %zu: %zu plies, %d blunders, %d missed wins, %lld ms\n", g, moves.size(),
+               marks[Move_annotation::Blunder], marks[Move_annotation::Missed_win], (long long)ms);
+        for (size_t k = 0; k < moves.size(); ++k)
+        {
+            if (moves[k].kind == Move_annotation::None)
+                continue;
+            printf("  %zu%s %s: %s, best %s (%s -> %s)\n", k / 2 + 1, k % 2 ? "..." : ".",
+                   Engine::move_to_string(moves[k].played).c_str(),
+                   moves[k].kind == Move_annotation::Blunder ? "blunder" : "missed win",
+                   Engine::move_to_string(moves[k].best).c_str(), score_text(moves[k].best_score).c_str(),
+                   score_text(moves[k].played_score).c_str());
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("usage: game_db build <prefix> <games.pdn>... [--threads T]\n"
+               "       game_db query <prefix> <FEN|startpos> [--games N]\n"
+               "       game_db bench <prefix> [--queries N]\n"
+               "       game_db book <prefix> <book.txt> [--min-games N] [--plies P]\n"
+               "       game_db analyze <games.pdn> [--games N] [--depth D] [--threads T]\n");
+        return 1;
+    }
+    const string mode = argv[1];
+    Options opt;
+    vector<string> args;
+    for (int k = 2; k < argc; ++k)
+    {
+        if (!strncmp(argv[k], "--", 2) && k + 1 < argc)
+        {
+            const char* value = argv[++k];
+            if (!strcmp(argv[k - 1], "--threads"))
+                opt.threads = atoi(value);
+            else if (!strcmp(argv[k - 1], "--games"))
+                opt.games = size_t(atoll(value));
+            else if (!strcmp(argv[k - 1], "--queries"))
+                opt.queries = max<size_t>(1, size_t(atoll(value)));
+            else if (!strcmp(argv[k - 1], "--min-games"))
+                opt.min_games = uint32_t(atoll(value));
+            else if (!strcmp(argv[k - 1], "--plies"))
+                opt.plies = atoi(value);
+            else if (!strcmp(argv[k - 1], "--depth"))
+                opt.depth = atoi(value);
+        }
+        else
+            args.push_back(argv[k]);
+    }
+    if (mode == "build" && args.size() >= 2)
+        return build(args[0], vector<string>(args.begin() + 1, args.end()), opt);
+    if (mode == "query" && args.size() == 2)
+        return query(args[0], args[1], opt);
+    if (mode == "bench" && args.size() == 1)
+        return bench(args[0], opt);
+    if (mode == "book" && args.size() == 2)
+        return book(args[0], args[1], opt);
+    if (mode == "analyze" && args.size() == 1)
+        return analyze(args[0], opt);
+    printf("bad arguments\n");
+    return 1;
+}
@@ -0,0 +1,479 @@
+// Сервис партий: много независимых сессий с ботом в одном процессе вместо процесса на партию.
+// Поиски всех сессий выполняются на общем пуле потоков, таблицы перестановок ограничены
+// бюджетами памяти на сессию и на весь сервис.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/game_service.cpp -o game_service
+// Запуск: game_service [--socket PATH] [--threads N] [--hash-total MB] [--hash-session MB]
+//                      [--scoring NumberAndPotential] [--optimization O1] [--nnue PATH] [--ntuple PATH]
+//                      [--shared 1] [--shared-hash MB]
+// --shared 1 кладёт сеть NNUE в общую память, --shared-hash подключает все сессии к таблице перестановок
+// в общей памяти /checkers-hash (общей и с другими процессами движка), бюджеты на неё не действуют.
+//
+// Протокол - строки через Unix-сокет (по умолчанию /tmp/checkers.sock):
+//   new [hash_mb]                             -> session ID hash BYTES
+//   position ID startpos|fen FEN [moves ...]  -> ok ID | error ID <причина>
+//   move ID 22-18                             -> ok ID | error ID <причина>
+//   go ID [depth N] [movetime MS] [nodes N]   -> bestmove ID MOVE|none score S depth D nodes N latency MS
+//                                                (ход бота сразу делается в партии сессии)
+//   stats [ID]                                -> stats ID moves N p50 MS p99 MS max MS, затем stats total ...
+//   close ID                                  -> closed ID
+//   shutdown                                  -> остановка сервиса
+// Команды одной сессии выполняются по порядку, сессии обслуживаются по очереди.
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../Engine/Engine.h"
+#include "../Engine/Thread_pool.h"
+#include "Socket_io.h"
+
+// Задержки ходов (от получения go до отправки bestmove) в миллисекундах
+class Latency_stats
+{
+public:
+    void add(const double ms)
+    {
+        lock_guard<mutex> lock(m);
+        samples.push_back(ms);
+    }
+
+    size_t count()
+    {
+        lock_guard<mutex> lock(m);
+        return samples.size();
+    }
+
+    string summary()
+    {
+        vector<double> sorted;
+        {
+            lock_guard<mutex> lock(m);
+            sorted = samples;
+        }
+        sort(sorted.begin(), sorted.end());
+        auto pct = [&](const double p) {
+            return sorted.empty() ? 0.0 : sorted[min(sorted.size() - 1, size_t(p * sorted.size()))];
+        };
+        char buf[128];
+        snprintf(buf, sizeof(buf), "moves %zu p50 %.1f p99 %.1f max %.1f", sorted.size(), pct(0.5), pct(0.99),
+                 sorted.empty() ? 0.0 : sorted.back());
+        return buf;
+    }
+
+private:
+    mutex m;
+    vector<double> samples;
+};
+
+// Бюджет памяти таблиц перестановок: общий на сервис и максимальный на одну сессию
+class Hash_budget
+{
+public:
+    Hash_budget(const size_t total, const size_t per_session) : total(total), per_session(per_session)
+    {
+    }
+
+    // Выделение не больше запрошенного, лимита сессии и остатка общего бюджета
+    size_t acquire(const size_t request)
+    {
+        lock_guard<mutex> lock(m);
+        const size_t res = min({request, per_session, total - used});
+        used += res;
+        return res;
+    }
+
+    void release(const size_t bytes)
+    {
+        lock_guard<mutex> lock(m);
+        used -= bytes;
+    }
+
+    size_t in_use()
+    {
+        lock_guard<mutex> lock(m);
+        return used;
+    }
+
+    const size_t total, per_session;
+
+private:
+    mutex m;
+    size_t used = 0;
+};
+
+// Клиентское соединение, ответы пишутся из разных потоков пула
+struct Connection
+{
+    explicit Connection(const int fd) : fd(fd)
+    {
+    }
+
+    ~Connection()
+    {
+        close(fd);
+    }
+
+    void send(const string& line)
+    {
+        lock_guard<mutex> lock(write_mutex);
+        write_line(fd, line);
+    }
+
+    const int fd;
+    mutex write_mutex;
+};
+
+// Партия с ботом: движок, своя таблица перестановок и очередь команд
+struct Session
+{
+    Session(const int id, const Bot_options& options, Hash_budget& budget, const size_t hash_request,
+            const size_t shared_hash, shared_ptr<Connection> conn)
+        : id(id), engine(options), budget(budget), conn(move(conn))
+    {
+        if (shared_hash && engine.set_shared_hash("/checkers-hash", shared_hash))
+            return;
+        const size_t granted = budget.acquire(hash_request);
+        engine.set_hash_size(granted);
+        hash_bytes = engine.hash_size();
+        budget.release(granted - hash_bytes);
+    }
+
+    ~Session()
+    {
+        budget.release(hash_bytes);
+    }
+
+    const int id;
+    Engine engine;
+    Hash_budget& budget;
+    size_t hash_bytes = 0;
+    shared_ptr<Connection> conn;
+    Latency_stats latency;
+
+    mutex m; // защищает очередь и флаги
+    deque<function<void()>> requests;
+    bool busy = false;   // команда сессии уже стоит в пуле или выполняется
+    bool closed = false;
+};
+
+class Game_service
+{
+public:
+    Game_service(const Bot_options& options, const size_t threads, const size_t hash_total, const size_t hash_session,
+                 const size_t shared_hash)
+        : options(options), budget(hash_total, hash_session), shared_hash(shared_hash), pool(threads),
+          start(chrono::steady_clock::now())
+    {
+    }
+
+    // Приём соединений до команды shutdown
+    int run(const string& path)
+    {
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        const sockaddr_un addr = socket_address(path);
+        unlink(path.c_str());
+        if (listen_fd < 0 || bind(listen_fd, (const sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0)
+        {
+            printf("can't listen on %s: %s\n", path.c_str(), strerror(errno));
+            return 1;
+        }
+        printf("listening on %s, %zu threads, hash %zu MB total / %zu MB per session\n", path.c_str(), pool.size(),
+               budget.total >> 20, budget.per_session >> 20);
+        fflush(stdout);
+        vector<thread> readers;
+        while (!stopping)
+        {
+            const int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            auto conn = make_shared<Connection>(fd);
+            {
+                lock_guard<mutex> lock(conn_mutex);
+                connections.push_back(conn);
+            }
+            readers.emplace_back([this, conn]() { serve(conn); });
+        }
+        {
+            // разбудить потоки, ждущие команд от клиентов
+            lock_guard<mutex> lock(conn_mutex);
+            for (auto& weak : connections)
+                if (auto conn = weak.lock())
+                    shutdown(conn->fd, SHUT_RDWR);
+        }
+        for (auto& t : readers)
+            t.join();
+        pool.wait_idle();
+        close(listen_fd);
+        unlink(path.c_str());
+        return 0;
+    }
+
+private:
+    // Чтение команд одного клиента
+    void serve(const shared_ptr<Connection>& conn)
+    {
+        Line_reader reader(conn->fd);
+        string line;
+        vector<int> own; // сессии, открытые этим клиентом
+        while (!stopping && reader.read_line(line))
+        {
+            stringstream ss(line);
+            string cmd;
+            ss >> cmd;
+            if (cmd == "new")
+            {
+                double mb = -1;
+                ss >> mb;
+                const size_t request = mb < 0 ? budget.per_session : size_t(mb * (1 << 20));
+                auto s = make_shared<Session>(next_id++, options, budget, request, shared_hash, conn);
+                {
+                    lock_guard<mutex> lock(sessions_mutex);
+                    sessions[s->id] = s;
+                }
+                own.push_back(s->id);
+                conn->send("session " + to_string(s->id) + " hash " + to_string(s->engine.hash_size()));
+            }
+            else if (cmd == "position" || cmd == "move" || cmd == "go")
+            {
+                int id = -1;
+                ss >> id;
+                auto s = find(id);
+                if (!s)
+                {
+                    conn->send("error " + to_string(id) + " no session");
+                    continue;
+                }
+                string args;
+                getline(ss, args);
+                const auto received = chrono::steady_clock::now();
+                enqueue(s, [this, s, cmd, args, received]() { execute(*s, cmd, args, received); });
+            }
+            else if (cmd == "stats")
+            {
+                int id = -1;
+                if (ss >> id)
+                {
+                    if (auto s = find(id))
+                        conn->send("stats " + to_string(id) + " " + s->latency.summary());
+                }
+                else
+                {
+                    lock_guard<mutex> lock(sessions_mutex);
+                    for (auto& it : sessions)
+                        conn->send("stats " + to_string(it.first) + " " + it.second->latency.summary());
+                }
+                conn->send(total_stats());
+            }
+            else if (cmd == "close")
+            {
+                int id = -1;
+                ss >> id;
+                close_session(id);
+                conn->send("closed " + to_string(id));
+            }
+            else if (cmd == "shutdown")
+            {
+                stopping = true;
+                shutdown(listen_fd, SHUT_RDWR);
+            }
+            else if (!cmd.empty())
+                conn->send("error unknown command " + cmd);
+        }
+        for (int id : own)
+            close_session(id);
+    }
+
+    shared_ptr<Session> find(const int id)
+    {
+        lock_guard<mutex> lock(sessions_mutex);
+        auto it = sessions.find(id);
+        return it == sessions.end() ? nullptr : it->second;
+    }
+
+    void close_session(const int id)
+    {
+        shared_ptr<Session> s;
+        {
+            lock_guard<mutex> lock(sessions_mutex);
+            auto it = sessions.find(id);
+            if (it == sessions.end())
+                return;
+            s = it->second;
+            sessions.erase(it);
+        }
+        lock_guard<mutex> lock(s->m);
+        s->closed = true;
+        s->requests.clear();
+        // флаг остановки у сессии больше не сбрасывается: поиск, ещё не дошедший до search(), тоже прервётся
+        s->engine.stop();
+        // память таблицы вернётся в бюджет, когда завершится выполняемая команда
+    }
+
+    // Команды сессии выполняются строго по одной: в пуле стоит не больше одной задачи на сессию,
+    // после каждой команды сессия встаёт в конец очереди, и ядра делятся между сессиями поровну
+    void enqueue(const shared_ptr<Session>& s, function<void()> request)
+    {
+        lock_guard<mutex> lock(s->m);
+        if (s->closed)
+            return;
+        s->requests.push_back(move(request));
+        if (!s->busy)
+        {
+            s->busy = true;
+            pool.submit([this, s]() { run_next(s); });
+        }
+    }
+
+    void run_next(const shared_ptr<Session>& s)
+    {
+        function<void()> request;
+        {
+            lock_guard<mutex> lock(s->m);
+            if (s->closed || s->requests.empty())
+            {
+                s->busy = false;
+                return;
+            }
+            request = move(s->requests.front());
+            s->requests.pop_front();
+        }
+        request();
+        lock_guard<mutex> lock(s->m);
+        if (s->closed || s->requests.empty())
+            s->busy = false;
+        else
+            pool.submit([this, s]() { run_next(s); });
+    }
+
+    void execute(Session& s, const string& cmd, const string& args, const chrono::steady_clock::time_point received)
+    {
+        stringstream ss(args);
+        const string id = to_string(s.id);
+        if (cmd == "position")
+        {
+            string word;
+            ss >> word;
+            if (word == "fen")
+            {
+                ss >> word;
+                if (!s.engine.set_position(word))
+                    return s.conn->send("error " + id + " bad fen");
+            }
+            else
+                s.engine.set_start_position();
+            if (ss >> word && word == "moves")
+                while (ss >> word)
+                    if (!s.engine.play(word))
+                        return s.conn->send("error " + id + " illegal move " + word);
+            s.conn->send("ok " + id);
+        }
+        else if (cmd == "move")
+        {
+            string word;
+            ss >> word;
+            s.conn->send(s.engine.play(word) ? "ok " + id : "error " + id + " illegal move " + word);
+        }
+        else
+        {
+            Search_limits limits;
+            limits.depth = 6;
+            string word;
+            while (ss >> word)
+            {
+                if (word == "depth")
+                    ss >> limits.depth;
+                else if (word == "movetime")
+                    ss >> limits.time_ms;
+                else if (word == "nodes")
+                    ss >> limits.nodes;
+            }
+            const auto res = s.engine.search(limits);
+            if (!res.turn.empty())
+                s.engine.play(res.turn);
+            const double latency =
+                chrono::duration<double, milli>(chrono::steady_clock::now() - received).count();
+            s.latency.add(latency);
+            total_latency.add(latency);
+            char buf[128];
+            snprintf(buf, sizeof(buf), " score %.4g depth %d nodes %lld latency %.1f", res.score, res.depth,
+                     (long long)res.nodes, latency);
+            s.conn->send("bestmove " + id + " " + (res.turn.empty() ? string("none") : Engine::move_to_string(res.turn)) +
+                         buf);
+        }
+    }
+
+    string total_stats()
+    {
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        size_t count;
+        {
+            lock_guard<mutex> lock(sessions_mutex);
+            count = sessions.size();
+        }
+        char buf[256];
+        snprintf(buf, sizeof(buf), " moves_per_sec %.1f sessions %zu hash_used %zu hash_total %zu threads %zu steals %llu",
+                 total_latency.count() / max(seconds, 1e-9), count, budget.in_use(), budget.total, pool.size(),
+                 (unsigned long long)pool.steals());
+        return "stats total " + total_latency.summary() + buf;
+    }
+
+    const Bot_options options;
+    Hash_budget budget;
+    const size_t shared_hash; // размер общей таблицы (0 - у каждой сессии своя)
+    Thread_pool pool;
+    const chrono::steady_clock::time_point start;
+    Latency_stats total_latency;
+    atomic<bool> stopping{false};
+    atomic<int> next_id{1};
+    int listen_fd = -1;
+    mutex sessions_mutex;
+    map<int, shared_ptr<Session>> sessions;
+    mutex conn_mutex;
+    vector<weak_ptr<Connection>> connections;
+};
+
+int main(int argc, char* argv[])
+{
+    string path = "/tmp/checkers.sock";
+    size_t threads = 0;
+    double hash_total = 256, hash_session = 16, shared_hash = 0;
+    Bot_options options;
+    for (int a = 1; a + 1 < argc; a += 2)
+    {
+        const string arg = argv[a], value = argv[a + 1];
+        if (arg == "--socket")
+            path = value;
+        else if (arg == "--threads")
+            threads = size_t(atoi(value.c_str()));
+        else if (arg == "--hash-total")
+            hash_total = atof(value.c_str());
+        else if (arg == "--hash-session")
+            hash_session = atof(value.c_str());
+        else if (arg == "--scoring")
+            options.scoring = Bot_options::parse_scoring(value);
+        else if (arg == "--optimization")
+            options.optimization = Bot_options::parse_optimization(value);
+        else if (arg == "--nnue")
+            options.nnue_path = value;
+        else if (arg == "--ntuple")
+            options.ntuple_path = value;
+        else if (arg == "--shared")
+            options.shared_memory = (value == "1");
+        else if (arg == "--shared-hash")
+            shared_hash = atof(value.c_str());
+    }
+    signal(SIGPIPE, SIG_IGN);
+    Game_service service(options, threads, size_t(hash_total * (1 << 20)), size_t(hash_session * (1 << 20)),
+                         size_t(shared_hash * (1 << 20)));
+    return service.run(path);
+}
@@ -0,0 +1,145 @@
+// Генератор нагрузки для game_service: N сессий играют бот против бота, пока не сделают M ходов каждая.
+// Сборка: g++ -std=c++17 -O2 Tools/load_client.cpp -o load_client
+// Запуск: load_client [--socket PATH] [--sessions N] [--moves M] [--depth D] [--movetime MS] [--hash MB] [--shutdown 1]
+// Выводит пропускную способность (ходов в секунду), задержки p50/p99 по данным клиента и статистику сервиса.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "Socket_io.h"
+
+struct Client_session
+{
+    int moves = 0;  // сделано ходов
+    int games = 0;  // начато партий
+    chrono::steady_clock::time_point sent;
+};
+
+int main(int argc, char* argv[])
+{
+    string path = "/tmp/checkers.sock", go = "go";
+    int sessions = 16, moves = 50, depth = 4;
+    long movetime = 0;
+    double hash_mb = -1;
+    bool stop_service = false;
+    for (int a = 1; a + 1 < argc; a += 2)
+    {
+        const string arg = argv[a], value = argv[a + 1];
+        if (arg == "--socket")
+            path = value;
+        else if (arg == "--sessions")
+            sessions = atoi(value.c_str());
+        else if (arg == "--moves")
+            moves = atoi(value.c_str());
+        else if (arg == "--depth")
+            depth = atoi(value.c_str());
+        else if (arg == "--movetime")
+            movetime = atol(value.c_str());
+        else if (arg == "--hash")
+            hash_mb = atof(value.c_str());
+        else if (arg == "--shutdown")
+            stop_service = (value == "1");
+    }
+    go += " depth " + to_string(depth);
+    if (movetime)
+        go += " movetime " + to_string(movetime);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    const sockaddr_un addr = socket_address(path);
+    if (fd < 0 || connect(fd, (const sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        printf("can't connect to %s: %s\n", path.c_str(), strerror(errno));
+        return 1;
+    }
+    Line_reader reader(fd);
+    string line;
+
+    // открытие сессий
+    map<int, Client_session> state;
+    for (int k = 0; k < sessions; ++k)
+    {
+        write_line(fd, hash_mb < 0 ? "new" : "new " + to_string(hash_mb));
+        string word;
+        int id = 0;
+        size_t bytes = 0;
+        if (!reader.read_line(line) || !(stringstream(line) >> word >> id >> word >> bytes))
+        {
+            printf("bad reply: %s\n", line.c_str());
+            return 1;
+        }
+        state[id];
+        if (k == 0 || k + 1 == sessions)
+            printf("session %d: hash %zu bytes\n", id, bytes);
+    }
+
+    const auto start = chrono::steady_clock::now();
+    for (auto& it : state)
+    {
+        it.second.sent = chrono::steady_clock::now();
+        write_line(fd, "go " + to_string(it.first) + go.substr(2));
+    }
+
+    // каждый ответ bestmove порождает следующий запрос той же сессии
+    vector<double> latency;
+    int active = int(state.size());
+    while (active > 0 && reader.read_line(line))
+    {
+        stringstream ss(line);
+        string cmd, move;
+        int id = 0;
+        ss >> cmd >> id;
+        if (cmd == "ok")
+            continue;
+        if (cmd != "bestmove")
+        {
+            printf("%s\n", line.c_str());
+            continue;
+        }
+        ss >> move;
+        Client_session& s = state[id];
+        latency.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - s.sent).count());
+        if (move != "none")
+            ++s.moves;
+        if (s.moves >= moves)
+        {
+            --active;
+            continue;
+        }
+        s.sent = chrono::steady_clock::now();
+        // партия закончилась - начинаем новую
+        if (move == "none")
+        {
+            ++s.games;
+            write_line(fd, "position " + to_string(id) + " startpos");
+        }
+        write_line(fd, "go " + to_string(id) + go.substr(2));
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    sort(latency.begin(), latency.end());
+    auto pct = [&](const double p) {
+        return latency.empty() ? 0.0 : latency[min(latency.size() - 1, size_t(p * latency.size()))];
+    };
+    printf("%zu moves in %.2f s: %.1f moves/s, latency p50 %.1f ms, p99 %.1f ms, max %.1f ms\n", latency.size(),
+           seconds, latency.size() / seconds, pct(0.5), pct(0.99), latency.empty() ? 0.0 : latency.back());
+
+    write_line(fd, "stats");
+    while (reader.read_line(line))
+    {
+        if (line.rfind("stats total", 0) == 0)
+        {
+            printf("service: %s\n", line.c_str() + 12);
+            break;
+        }
+    }
+    for (auto& it : state)
+        write_line(fd, "close " + to_string(it.first));
+    if (stop_service)
+        write_line(fd, "shutdown");
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,346 @@
+// Тренер сети NNUE по позициям из партий бота против самого себя.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/nnue_trainer.cpp -o nnue_trainer
+// Запуск: nnue_trainer <out.nnue> <samples.bin>... [--epochs N] [--lambda L] [--lr R]
+//         nnue_trainer match <net.nnue> [--games N] [--movetime MS] [--random-plies R] [--max-plies P]
+//                                       [--openings suite.txt]
+// Входные файлы - позиции position_sample (Models/Sample_stream.h, сжатые или нет, например от selfplay),
+// выход - файл для Bot/NNUEPath.
+// match играет сетью против NumberAndPotential с одинаковым временем на ход: пара партий на дебют со сменой
+// цветов, дебют - R случайных полуходов или позиция из набора Tools/opening_suite.cpp.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "../Engine/Engine.h"
+#include "../Models/Sample_stream.h"
+
+// Сеть с весами float той же архитектуры, что и NNUE
+struct Float_net
+{
+    static const int In = NNUE::Inputs, H1 = NNUE::Hidden, H2 = NNUE::Hidden2;
+    static const int Size = H1 + In * H1 + H2 + H2 * H1 + 1 + H2;
+
+    vector<float> p = vector<float>(Size); // все параметры подряд
+    float* b1() { return p.data(); }
+    float* w1() { return b1() + H1; }
+    float* b2() { return w1() + In * H1; }
+    float* w2() { return b2() + H2; }
+    float* b3() { return w2() + H2 * H1; }
+    float* w3() { return b3() + 1; }
+
+    void init(mt19937& rng)
+    {
+        uniform_real_distribution<float> d1(-0.05f, 0.05f), d2(-0.2f, 0.2f);
+        for (int k = 0; k < H1; ++k)
+            b1()[k] = 0.1f;
+        for (int k = 0; k < In * H1; ++k)
+            w1()[k] = d1(rng);
+        for (int k = 0; k < H2 * H1; ++k)
+            w2()[k] = d2(rng);
+        for (int k = 0; k < H2; ++k)
+        {
+            b2()[k] = 0.1f;
+            w3()[k] = d2(rng);
+        }
+        b3()[0] = 0;
+    }
+
+    // int8 веса должны оставаться в представимом после квантования диапазоне
+    void clamp_weights()
+    {
+        const float lim = 127.0f / (1 << NNUE::Weight_shift);
+        for (int k = 0; k < H2 * H1; ++k)
+            w2()[k] = min(max(w2()[k], -lim), lim);
+        for (int k = 0; k < H2; ++k)
+            w3()[k] = min(max(w3()[k], -lim), lim);
+    }
+
+    // Перевод в целочисленную сеть
+    void quantize(NNUE::Weights& net)
+    {
+        const float act = NNUE::Act_max, wq = 1 << NNUE::Weight_shift;
+        net.allocate();
+        for (int k = 0; k < H1; ++k)
+            net.b1[k] = int16_t(lround(b1()[k] * act));
+        for (int k = 0; k < In * H1; ++k)
+            net.w1[k] = int16_t(lround(w1()[k] * act));
+        for (int m = 0; m < H2; ++m)
+        {
+            net.b2[m] = int32_t(lround(b2()[m] * act * wq));
+            net.w3[m] = int8_t(lround(w3()[m] * wq));
+        }
+        for (int k = 0; k < H2 * H1; ++k)
+            net.w2[k] = int8_t(lround(w2()[k] * wq));
+        net.b3[0] = int32_t(lround(b3()[0] * act * wq));
+    }
+};
+
+// Активные признаки позиции в нумерации NNUE::feature
+static int features(const position_sample& s, int* out)
+{
+    int n = 0;
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        for (POS_T j = (i + 1) % 2; j < 8; j += 2)
+        {
+            const POS_T type = s.at(i, j);
+            if (type)
+                out[n++] = NNUE::feature(type, i, j);
+        }
+    }
+    return n;
+}
+
+static float sigmoid(const float x)
+{
+    return 1.0f / (1.0f + exp(-x));
+}
+
+// Матч сети против NumberAndPotential с одинаковым временем на ход
+static int match(int argc, char* argv[])
+{
+    const string path = argv[2];
+    int games = 20, random_plies = 4, max_plies = 200;
+    int64_t movetime = 100;
+    string openings_path;
+    for (int a = 3; a + 1 < argc; a += 2)
+    {
+        if (!strcmp(argv[a], "--games"))
+            games = atoi(argv[a + 1]);
+        else if (!strcmp(argv[a], "--movetime"))
+            movetime = atoll(argv[a + 1]);
+        else if (!strcmp(argv[a], "--random-plies"))
+            random_plies = atoi(argv[a + 1]);
+        else if (!strcmp(argv[a], "--max-plies"))
+            max_plies = atoi(argv[a + 1]);
+        else if (!strcmp(argv[a], "--openings"))
+            openings_path = argv[a + 1];
+    }
+    if (!NNUE().load(path))
+    {
+        printf("can't read %s\n", path.c_str());
+        return 1;
+    }
+    vector<string> openings; // FEN начальных позиций (первое слово строки набора)
+    if (!openings_path.empty())
+    {
+        ifstream fin(openings_path);
+        string line, fen;
+        while (getline(fin, line))
+            if (stringstream(line) >> fen)
+                openings.push_back(fen);
+        if (openings.empty())
+        {
+            printf("no openings in %s\n", openings_path.c_str());
+            return 1;
+        }
+    }
+    Bot_options nnue, classic;
+    nnue.scoring = Scoring::NNUE;
+    nnue.nnue_path = path;
+    int score[3] = {}; // с точки зрения сети: поражения, ничьи, победы
+    int64_t nodes[2] = {}, ms[2] = {}, depth[2] = {}, moves[2] = {};
+    for (int g = 0; g < games; ++g)
+    {
+        // один дебют на пару партий, сеть играет белыми в чётных
+        Engine board;
+        if (!openings.empty())
+        {
+            if (!board.set_position(openings[(g / 2) % openings.size()]))
+            {
+                printf("bad opening %s\n", openings[(g / 2) % openings.size()].c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            mt19937 opening(unsigned(7919 + g / 2));
+            for (int k = 0; k < random_plies; ++k)
+            {
+                auto turns = board.legal_moves();
+                if (turns.empty())
+                    break;
+                board.play(turns[opening() % turns.size()]);
+            }
+        }
+        Engine engines[2] = {Engine(classic), Engine(nnue)};
+        const bool nnue_color = (g % 2 != 0);
+        int result = 1;
+        for (int ply = 0; ply < max_plies; ++ply)
+        {
+            if (board.legal_moves().empty())
+            {
+                result = (board.side_to_move() == nnue_color) ? 0 : 2;
+                break;
+            }
+            const int side = (board.side_to_move() == nnue_color) ? 1 : 0;
+            Engine& e = engines[side];
+            e.set_position(board.position());
+            Search_limits limits;
+            limits.time_ms = movetime;
+            const auto res = e.search(limits);
+            nodes[side] += res.nodes;
+            ms[side] += res.time_ms;
+            depth[side] += max(0, res.depth);
+            moves[side]++;
+            board.play(res.turn);
+        }
+        ++score[result];
+        printf("game %d: %s\n", g + 1, result == 1 ? "draw" : (result == 2 ? "NNUE wins" : "NumberAndPotential wins"));
+    }
+    printf("NNUE vs NumberAndPotential, movetime %lld ms: +%d =%d -%d (%.1f%%)\n", (long long)movetime, score[2],
+           score[1], score[0], 100.0 * (score[2] + 0.5 * score[1]) / max(1, games));
+    printf("nodes/sec: NNUE %.0f, NumberAndPotential %.0f; average depth: NNUE %.1f, NumberAndPotential %.1f\n",
+           1000.0 * nodes[1] / max<int64_t>(1, ms[1]), 1000.0 * nodes[0] / max<int64_t>(1, ms[0]),
+           double(depth[1]) / max<int64_t>(1, moves[1]), double(depth[0]) / max<int64_t>(1, moves[0]));
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 3 && !strcmp(argv[1], "match"))
+        return match(argc, argv);
+    if (argc < 3)
+    {
+        printf("usage: nnue_trainer <out.nnue> <samples.bin>... [--epochs N] [--lambda L] [--lr R]\n"
+               "       nnue_trainer match <net.nnue> [--games N] [--movetime MS] [--random-plies R] [--max-plies P]\n"
+               "                                     [--openings suite.txt]\n");
+        return 1;
+    }
+    string out_path = argv[1];
+    int epochs = 10;
+    float lambda = 0.5f, lr = 1e-3f;
+    vector<position_sample> data;
+    for (int a = 2; a < argc; ++a)
+    {
+        if (!strcmp(argv[a], "--epochs") && a + 1 < argc)
+            epochs = atoi(argv[++a]);
+        else if (!strcmp(argv[a], "--lambda") && a + 1 < argc)
+            lambda = float(atof(argv[++a]));
+        else if (!strcmp(argv[a], "--lr") && a + 1 < argc)
+            lr = float(atof(argv[++a]));
+        else if (!Sample_reader::load(argv[a], data))
+            printf("can't read %s\n", argv[a]);
+    }
+    if (data.empty())
+    {
+        printf("no samples\n");
+        return 1;
+    }
+    printf("samples: %zu\n", data.size());
+
+    const int H1 = Float_net::H1, H2 = Float_net::H2;
+    const int Batch = 256;
+    mt19937 rng(0);
+    Float_net net, grad;
+    net.init(rng);
+    // моменты Adam
+    vector<float> m1(Float_net::Size), m2(Float_net::Size);
+    const float beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+    int step = 0;
+
+    vector<float> acc(H1), h1(H1), z2(H2), h2(H2), d1(H1), d2(H2);
+    int active[32];
+    for (int epoch = 1; epoch <= epochs; ++epoch)
+    {
+        shuffle(data.begin(), data.end(), rng);
+        double loss_sum = 0;
+        for (size_t start = 0; start < data.size(); start += Batch)
+        {
+            const size_t end = min(data.size(), start + Batch);
+            fill(grad.p.begin(), grad.p.end(), 0.0f);
+            for (size_t s = start; s < end; ++s)
+            {
+                const position_sample& smp = data[s];
+                const int n = features(smp, active);
+
+                // прямой проход
+                copy(net.b1(), net.b1() + H1, acc.begin());
+                for (int f = 0; f < n; ++f)
+                {
+                    const float* w = net.w1() + active[f] * H1;
+                    for (int k = 0; k < H1; ++k)
+                        acc[k] += w[k];
+                }
+                for (int k = 0; k < H1; ++k)
+                    h1[k] = min(max(acc[k], 0.0f), 1.0f);
+                float out = net.b3()[0];
+                for (int m = 0; m < H2; ++m)
+                {
+                    const float* w = net.w2() + m * H1;
+                    float z = net.b2()[m];
+                    for (int k = 0; k < H1; ++k)
+                        z += h1[k] * w[k];
+                    z2[m] = z;
+                    h2[m] = min(max(z, 0.0f), 1.0f);
+                    out += h2[m] * net.w3()[m];
+                }
+
+                // цель: смесь оценки поиска и результата партии
+                const float target = lambda * sigmoid(float(smp.score) / NNUE::Score_scale) +
+                                     (1 - lambda) * (smp.result + 1) * 0.5f;
+                const float pred = sigmoid(out);
+                loss_sum += (pred - target) * (pred - target);
+                const float dout = 2 * (pred - target) * pred * (1 - pred);
+
+                // обратный проход
+                grad.b3()[0] += dout;
+                fill(d1.begin(), d1.end(), 0.0f);
+                for (int m = 0; m < H2; ++m)
+                {
+                    grad.w3()[m] += dout * h2[m];
+                    d2[m] = (z2[m] > 0 && z2[m] < 1) ? dout * net.w3()[m] : 0.0f;
+                    if (d2[m] == 0)
+                        continue;
+                    grad.b2()[m] += d2[m];
+                    const float* w = net.w2() + m * H1;
+                    float* gw = grad.w2() + m * H1;
+                    for (int k = 0; k < H1; ++k)
+                    {
+                        gw[k] += d2[m] * h1[k];
+                        d1[k] += d2[m] * w[k];
+                    }
+                }
+                for (int k = 0; k < H1; ++k)
+                {
+                    if (acc[k] <= 0 || acc[k] >= 1)
+                        d1[k] = 0;
+                    grad.b1()[k] += d1[k];
+                }
+                for (int f = 0; f < n; ++f)
+                {
+                    float* gw = grad.w1() + active[f] * H1;
+                    for (int k = 0; k < H1; ++k)
+                        gw[k] += d1[k];
+                }
+            }
+
+            // шаг Adam
+            ++step;
+            const float scale = 1.0f / float(end - start);
+            const float c1 = 1 - pow(beta1, float(step)), c2 = 1 - pow(beta2, float(step));
+            for (int k = 0; k < Float_net::Size; ++k)
+            {
+                const float g = grad.p[k] * scale;
+                m1[k] = beta1 * m1[k] + (1 - beta1) * g;
+                m2[k] = beta2 * m2[k] + (1 - beta2) * g * g;
+                net.p[k] -= lr * (m1[k] / c1) / (sqrt(m2[k] / c2) + eps);
+            }
+            net.clamp_weights();
+        }
+
+        NNUE::Weights qnet;
+        net.quantize(qnet);
+        if (!qnet.save(out_path))
+        {
+            printf("can't write %s\n", out_path.c_str());
+            return 1;
+        }
+        printf("epoch %d: loss %.6f, saved %s\n", epoch, loss_sum / data.size(), out_path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,339 @@
+// Тренер оценки n-кортежами (Engine/Ntuple.h) обучением с временными разностями TD(lambda)
+// в партиях против самого себя.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/ntuple_trainer.cpp -o ntuple_trainer
+// Запуск: ntuple_trainer train <out.ntw> [--games N] [--threads T] [--round G] [--alpha A] [--lambda L]
+//                              [--epsilon E] [--max-plies P] [--init in.ntw] [--seed S]
+//         ntuple_trainer match <weights.ntw> [--games N] [--depth D] [--random-plies R] [--max-plies P]
+// train: обучение идёт раундами; в раунде каждый поток играет G партий со своей копией весов: ход -
+// лучший по оценке позиции после хода (с вероятностью E - случайный), после партии веса сдвигаются
+// к lambda-возвратам от итога. В конце раунда копии потоков усредняются. Выход - файл для
+// Bot/NTuplePath. match: бот NTuple против NumberAndPotential на глубине D, каждая случайная
+// дебютная позиция играется обоими цветами; печатает счёт и скорость поиска.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "../Engine/Engine.h"
+#include "../Engine/Ntuple.h"
+
+using Gen = Move_generator<Logic_rules>;
+
+struct Options
+{
+    int games = 100000;
+    int threads = 0;
+    int round = 100;
+    float alpha = 0.002f;
+    float lambda = 0.7f;
+    float epsilon = 0.1f;
+    int max_plies = 200;
+    string init;
+    unsigned seed = 1;
+    int depth = 4;
+    int random_plies = 4;
+};
+
+// Веса float той же раскладки, что в файле: таблица кортежа k начинается с k * Entries
+struct Float_net
+{
+    vector<Ntuple::Tuple> tuples;
+    vector<float> w;
+
+    // ln(отношения сил) с точки зрения белых, как Ntuple::evaluate
+    float evaluate(const uint8_t* s) const
+    {
+        uint8_t m[Ntuple::Squares];
+        Ntuple::mirror(s, m);
+        float sum = 0;
+        for (size_t t = 0; t < tuples.size(); ++t)
+            sum += w[t * Ntuple::Entries + Ntuple::index(s, tuples[t])] -
+                   w[t * Ntuple::Entries + Ntuple::index(m, tuples[t])];
+        return sum;
+    }
+
+    // Шаг по градиенту: оценка позиции s сдвигается на step
+    void update(const uint8_t* s, const float step)
+    {
+        uint8_t m[Ntuple::Squares];
+        Ntuple::mirror(s, m);
+        for (size_t t = 0; t < tuples.size(); ++t)
+        {
+            w[t * Ntuple::Entries + Ntuple::index(s, tuples[t])] += step;
+            w[t * Ntuple::Entries + Ntuple::index(m, tuples[t])] -= step;
+        }
+    }
+
+    Ntuple::Weights quantize() const
+    {
+        Ntuple::Weights res;
+        res.tuples = tuples;
+        res.w.resize(w.size());
+        for (size_t k = 0; k < w.size(); ++k)
+            res.w[k] = int16_t(max(-32767.0f, min(32767.0f, roundf(w[k] * Ntuple::Weight_scale))));
+        return res;
+    }
+};
+
+static float sigmoid(const float x)
+{
+    return 1.0f / (1.0f + exp(-x));
+}
+
+// Начальная расстановка: черные на клетках 1..12, белые на 21..32, ходят белые
+static Variant_position start_position()
+{
+    Variant_position pos;
+    pos.black = 0xFFFULL;
+    pos.white = 0xFFFULL << 20;
+    return pos;
+}
+
+struct Game_stats
+{
+    int64_t games = 0, plies = 0, results[3] = {}; // results: победы черных, ничьи, победы белых
+};
+
+// Одна партия и обучение по ней: net - копия весов потока
+static void play_and_learn(Float_net& net, const Options& opt, mt19937& rng, Game_stats& stats)
+{
+    typedef array<uint8_t, Ntuple::Squares> State;
+    vector<State> states;
+    Variant_position pos = start_position();
+    State s;
+    Ntuple::states(pos, s.data());
+    states.push_back(s);
+    uniform_real_distribution<float> unit(0, 1);
+    Move_list list;
+    float z = 0.5f; // итог с точки зрения белых
+    int result = 1;
+    for (int ply = 0; ply < opt.max_plies; ++ply)
+    {
+        Gen::generate(pos, list);
+        if (!list.size)
+        {
+            // ходящий проиграл
+            z = pos.color ? 1.0f : 0.0f;
+            result = pos.color ? 2 : 0;
+            break;
+        }
+        int best = 0;
+        if (unit(rng) < opt.epsilon)
+            best = int(rng() % list.size);
+        else
+        {
+            float best_v = 0;
+            for (int k = 0; k < list.size; ++k)
+            {
+                Ntuple::states(Gen::apply(pos, list.moves[k]), s.data());
+                const float v = pos.color ? -net.evaluate(s.data()) : net.evaluate(s.data());
+                if (k == 0 || v > best_v)
+                {
+                    best_v = v;
+                    best = k;
+                }
+            }
+        }
+        pos = Gen::apply(pos, list.moves[best]);
+        Ntuple::states(pos, s.data());
+        states.push_back(s);
+    }
+    ++stats.games;
+    stats.plies += int64_t(states.size()) - 1;
+    ++stats.results[result];
+
+    // lambda-возвраты с конца партии: G_T = z, G_t = (1 - lambda) V(s_t+1) + lambda G_t+1;
+    // значения считаются до шагов этой партии
+    vector<float> value(states.size());
+    for (size_t t = 0; t < states.size(); ++t)
+        value[t] = sigmoid(net.evaluate(states[t].data()));
+    float g = z;
+    for (size_t t = states.size(); t-- > 0;)
+    {
+        if (t + 1 < states.size())
+            g = (1 - opt.lambda) * value[t + 1] + opt.lambda * g;
+        // производная перекрёстной энтропии по ln(отношения сил) - разность вероятностей
+        net.update(states[t].data(), opt.alpha * (g - value[t]));
+    }
+}
+
+static int train(const string& out_path, const Options& opt)
+{
+    Float_net net;
+    if (!opt.init.empty())
+    {
+        Ntuple::Weights init;
+        if (!init.load(opt.init))
+        {
+            printf("can't read %s\n", opt.init.c_str());
+            return 1;
+        }
+        net.tuples = init.tuples;
+        for (auto v : init.w)
+            net.w.push_back(float(v) / Ntuple::Weight_scale);
+    }
+    else
+    {
+        net.tuples = Ntuple::standard_tuples();
+        net.w.assign(net.tuples.size() * Ntuple::Entries, 0.0f);
+    }
+    const int threads = opt.threads > 0 ? opt.threads : int(max(1u, thread::hardware_concurrency()));
+    printf("%zu tuples, %zu weights, %d threads\n", net.tuples.size(), net.w.size(), threads);
+    const auto start = chrono::steady_clock::now();
+    int played = 0;
+    for (int r = 0; played < opt.games; ++r)
+    {
+        const int per_thread = max(1, min(opt.round, (opt.games - played + threads - 1) / threads));
+        vector<Float_net> local(threads, net);
+        vector<Game_stats> stats(threads);
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                mt19937 rng(opt.seed * 1000003u + unsigned(r) * 1009u + unsigned(t));
+                for (int g = 0; g < per_thread; ++g)
+                    play_and_learn(local[t], opt, rng, stats[t]);
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+        // усреднение копий потоков
+        for (size_t k = 0; k < net.w.size(); ++k)
+        {
+            float sum = 0;
+            for (auto& l : local)
+                sum += l.w[k];
+            net.w[k] = sum / threads;
+        }
+        Game_stats total;
+        for (auto& st : stats)
+        {
+            total.games += st.games;
+            total.plies += st.plies;
+            for (int k = 0; k < 3; ++k)
+                total.results[k] += st.results[k];
+        }
+        played += int(total.games);
+        const double sec = max(chrono::duration<double>(chrono::steady_clock::now() - start).count(), 1e-9);
+        if (r % 10 == 0 || played >= opt.games)
+            printf("games %d: %.1f plies/game, white %.0f%%, draw %.0f%%, black %.0f%%, %.0f games/sec\n", played,
+                   double(total.plies) / total.games, 100.0 * total.results[2] / total.games,
+                   100.0 * total.results[1] / total.games, 100.0 * total.results[0] / total.games, played / sec);
+    }
+    if (!net.quantize().save(out_path))
+    {
+        printf("can't write %s\n", out_path.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+static int match(const string& path, const Options& opt)
+{
+    Bot_options ntuple, classic;
+    ntuple.scoring = Scoring::NTuple;
+    ntuple.ntuple_path = path;
+    if (!Ntuple().load(path))
+    {
+        printf("can't read %s\n", path.c_str());
+        return 1;
+    }
+    mt19937 rng(opt.seed);
+    int score[3] = {}; // с точки зрения NTuple: поражения, ничьи, победы
+    int64_t nodes[2] = {}, ms[2] = {};
+    for (int g = 0; g < opt.games; ++g)
+    {
+        // одна дебютная позиция на пару партий, NTuple играет белыми в чётных
+        Engine board;
+        mt19937 opening(unsigned(opt.seed * 7919u + g / 2));
+        for (int k = 0; k < opt.random_plies; ++k)
+        {
+            auto moves = board.legal_moves();
+            if (moves.empty())
+                break;
+            board.play(moves[opening() % moves.size()]);
+        }
+        Engine engines[2] = {Engine(classic), Engine(ntuple)};
+        const bool ntuple_color = (g % 2 != 0);
+        int result = 1;
+        for (int ply = 0; ply < opt.max_plies; ++ply)
+        {
+            if (board.legal_moves().empty())
+            {
+                result = (board.side_to_move() == ntuple_color) ? 0 : 2;
+                break;
+            }
+            const int side = (board.side_to_move() == ntuple_color) ? 1 : 0;
+            Engine& e = engines[side];
+            e.set_position(board.position());
+            Search_limits limits;
+            limits.depth = opt.depth;
+            const auto res = e.search(limits);
+            nodes[side] += res.nodes;
+            ms[side] += res.time_ms;
+            board.play(res.turn);
+        }
+        ++score[result];
+    }
+    printf("NTuple vs NumberAndPotential at depth %d: +%d =%d -%d (%.1f%%)\n", opt.depth, score[2], score[1],
+           score[0], 100.0 * (score[2] + 0.5 * score[1]) / max(1, opt.games));
+    printf("nodes/sec: NTuple %.0f, NumberAndPotential %.0f\n", 1000.0 * nodes[1] / max<int64_t>(1, ms[1]),
+           1000.0 * nodes[0] / max<int64_t>(1, ms[0]));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("usage: ntuple_trainer train <out.ntw> [--games N] [--threads T] [--round G] [--alpha A] [--lambda L]\n"
+               "                             [--epsilon E] [--max-plies P] [--init in.ntw] [--seed S]\n"
+               "       ntuple_trainer match <weights.ntw> [--games N] [--depth D] [--random-plies R] [--max-plies P]\n");
+        return 1;
+    }
+    const string mode = argv[1];
+    Options opt;
+    if (mode == "match")
+        opt.games = 20;
+    vector<string> files;
+    for (int k = 2; k < argc; ++k)
+    {
+        if (!strncmp(argv[k], "--", 2) && k + 1 < argc)
+        {
+            const char* value = argv[++k];
+            if (!strcmp(argv[k - 1], "--games"))
+                opt.games = atoi(value);
+            else if (!strcmp(argv[k - 1], "--threads"))
+                opt.threads = atoi(value);
+            else if (!strcmp(argv[k - 1], "--round"))
+                opt.round = max(1, atoi(value));
+            else if (!strcmp(argv[k - 1], "--alpha"))
+                opt.alpha = float(atof(value));
+            else if (!strcmp(argv[k - 1], "--lambda"))
+                opt.lambda = float(atof(value));
+            else if (!strcmp(argv[k - 1], "--epsilon"))
+                opt.epsilon = float(atof(value));
+            else if (!strcmp(argv[k - 1], "--max-plies"))
+                opt.max_plies = atoi(value);
+            else if (!strcmp(argv[k - 1], "--init"))
+                opt.init = value;
+            else if (!strcmp(argv[k - 1], "--seed"))
+                opt.seed = unsigned(atoll(value));
+            else if (!strcmp(argv[k - 1], "--depth"))
+                opt.depth = atoi(value);
+            else if (!strcmp(argv[k - 1], "--random-plies"))
+                opt.random_plies = atoi(value);
+        }
+        else
+            files.push_back(argv[k]);
+    }
+    if (mode == "train" && files.size() == 1)
+        return train(files[0], opt);
+    if (mode == "match" && files.size() == 1)
+        return match(files[0], opt);
+    printf("bad arguments\n");
+    return 1;
+}
@@ -0,0 +1,142 @@
+// Набор дебютов для сравнения ботов: все позиции через P полуходов от начальной расстановки оцениваются
+// неглубоким поиском в нескольких потоках, остаются различные позиции с оценкой близкой к равенству.
+// Каждую позицию bot_match играет дважды со сменой цветов, поэтому перевес дебюта не попадает в счёт,
+// а разные дебюты дают разные партии без случайных ходов.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/opening_suite.cpp -o opening_suite
+// Запуск: opening_suite <suite.txt> [--plies P] [--depth D] [--threads T] [--balance B] [--count N]
+// Строки файла: "FEN ходы оценка", ходы через запятую ("-" при P = 0), оценка - ln(отношения сил) с точки зрения белых.
+// Остаются позиции с |оценкой| не больше B (по возрастанию |оценки|, не больше N штук).
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#include "../Engine/Engine.h"
+
+struct Options
+{
+    int plies = 4;
+    int depth = 6;
+    int threads = 0;
+    double balance = 0.1;
+    size_t count = 0; // 0 - без ограничения
+};
+
+struct Opening
+{
+    string fen;
+    string moves; // ходы от начальной расстановки через запятую
+    double score = 0; // ln(отношения сил) с точки зрения белых
+};
+
+// Все различные позиции через plies полуходов; позиции без ходов (конец партии) не нужны
+static void enumerate(Engine& engine, const string& fen, const string& moves, const int plies, set<string>& seen,
+                      vector<Opening>& res)
+{
+    engine.set_position(fen);
+    const auto turns = engine.legal_moves();
+    if (turns.empty())
+        return;
+    if (plies == 0)
+    {
+        if (seen.insert(fen).second)
+            res.push_back({fen, moves, 0});
+        return;
+    }
+    for (auto& turn : turns)
+    {
+        engine.set_position(fen);
+        engine.play(turn);
+        const string next = engine.position();
+        enumerate(engine, next, (moves.empty() ? "" : moves + ",") + Engine::move_to_string(turn), plies - 1,
+                  seen, res);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: opening_suite <suite.txt> [--plies P] [--depth D] [--threads T] [--balance B] [--count N]\n");
+        return 1;
+    }
+    Options opt;
+    for (int k = 2; k + 1 < argc; k += 2)
+    {
+        if (!strcmp(argv[k], "--plies"))
+            opt.plies = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--depth"))
+            opt.depth = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--threads"))
+            opt.threads = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--balance"))
+            opt.balance = atof(argv[k + 1]);
+        else if (!strcmp(argv[k], "--count"))
+            opt.count = size_t(atoll(argv[k + 1]));
+    }
+    const auto start = chrono::steady_clock::now();
+    vector<Opening> openings;
+    {
+        Engine engine;
+        set<string> seen;
+        engine.set_start_position();
+        enumerate(engine, engine.position(), "", max(0, opt.plies), seen, openings);
+    }
+
+    // позиции разбираются потоками из общей очереди, у потока свой движок и таблица перестановок
+    atomic<size_t> next{0};
+    const int threads = max(1, min(int(openings.size()),
+                                   opt.threads > 0 ? opt.threads : int(max(1u, thread::hardware_concurrency()))));
+    Bot_options options;
+    options.no_random = true;
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&]() {
+            Engine engine(options);
+            engine.set_hash_size(16 << 20);
+            for (size_t k = next++; k < openings.size(); k = next++)
+            {
+                engine.set_position(openings[k].fen);
+                Search_limits limits;
+                limits.depth = opt.depth;
+                const auto res = engine.search(limits);
+                double score = is_win(res.score) ? HUGE_VAL : (is_loss(res.score) ? -HUGE_VAL : log(res.score));
+                openings[k].score = engine.side_to_move() ? -score : score;
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+
+    const size_t total = openings.size();
+    openings.erase(remove_if(openings.begin(), openings.end(),
+                             [&](const Opening& o) { return !(fabs(o.score) <= opt.balance); }),
+                   openings.end());
+    stable_sort(openings.begin(), openings.end(),
+                [](const Opening& a, const Opening& b) { return fabs(a.score) < fabs(b.score); });
+    if (opt.count && openings.size() > opt.count)
+        openings.resize(opt.count);
+
+    ofstream fout(argv[1]);
+    for (auto& o : openings)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%+.3f", o.score);
+        fout << o.fen << " " << (o.moves.empty() ? "-" : o.moves) << " " << buf << "\n";
+    }
+    if (!fout)
+    {
+        printf("can't write %s\n", argv[1]);
+        return 1;
+    }
+    const auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    printf("%zu positions after %d plies, %zu balanced (|score| <= %.3f) written to %s in %lld ms\n", total,
+           opt.plies, openings.size(), opt.balance, argv[1], (long long)ms);
+    return 0;
+}
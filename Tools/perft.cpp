@@ -0,0 +1,103 @@
+// Проверка генераторов ходов вариантов: количество позиций на каждой глубине (perft).
+// Для русских шашек ходы классического Engine сверяются с генератором Logic_rules (те же правила,
+// но дамка после взятия может остановиться на любом поле за снятой шашкой).
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/perft.cpp -o perft
+// Запуск: perft <russian|english|international> <глубина> [FEN]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <set>
+
+#include "../Engine/Variant_engine.h"
+
+// Ход без учёта пути: начало, конец и позиция после хода (пути с теми же снятыми шашками
+// Logic перечисляет отдельно, генератор вариантов считает одним ходом)
+static string move_key(const string& move, const string& after)
+{
+    const size_t first = move.find_first_of("-x"), last = move.find_last_of("-x");
+    return move.substr(0, first) + move.substr(last) + " " + after;
+}
+
+// Сравнение множеств ходов двух генераторов во всех позициях до глубины depth
+static bool compare_russian(Engine& classic, Variant_engine<Logic_rules>& variant, const int depth)
+{
+    const string fen = variant.position();
+    set<string> a, b;
+    classic.set_position(fen);
+    for (auto& turn : classic.legal_moves())
+    {
+        const string m = Engine::move_to_string(turn);
+        classic.set_position(fen);
+        classic.play(m);
+        variant.set_position(classic.position());
+        a.insert(move_key(m, variant.position()));
+    }
+    variant.set_position(fen);
+    const vector<string> moves = variant.legal_moves();
+    for (auto& m : moves)
+    {
+        variant.set_position(fen);
+        variant.play(m);
+        b.insert(move_key(m, variant.position()));
+    }
+    variant.set_position(fen);
+    if (a != b)
+    {
+        printf("mismatch at %s\n  engine: ", fen.c_str());
+        for (auto& m : a)
+            printf("%s; ", m.c_str());
+        printf("\n  rules:  ");
+        for (auto& m : b)
+            printf("%s; ", m.c_str());
+        printf("\n");
+        return false;
+    }
+    if (depth <= 1)
+        return true;
+    for (auto& m : moves)
+    {
+        variant.set_position(fen);
+        variant.play(m);
+        if (!compare_russian(classic, variant, depth - 1))
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("usage: perft <russian|english|international> <depth> [fen]\n");
+        return 1;
+    }
+    auto engine = make_variant_engine(argv[1]);
+    if (!engine)
+    {
+        printf("unknown variant %s\n", argv[1]);
+        return 1;
+    }
+    const int depth = atoi(argv[2]);
+    if (argc > 3 && !engine->set_position(argv[3]))
+    {
+        printf("bad position %s\n", argv[3]);
+        return 1;
+    }
+    for (int d = 1; d <= depth; ++d)
+    {
+        const auto start = chrono::steady_clock::now();
+        const uint64_t count = engine->perft(d);
+        const auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        printf("perft %d: %llu (%lld ms)\n", d, (unsigned long long)count, (long long)ms);
+    }
+    if (engine->name() == Russian_rules::Name)
+    {
+        Engine classic;
+        Variant_engine<Logic_rules> variant;
+        variant.set_position(engine->position());
+        const int check = min(depth, 5);
+        printf("compare with Engine to depth %d: %s\n", check,
+               compare_russian(classic, variant, check) ? "ok" : "failed");
+    }
+    return 0;
+}
@@ -0,0 +1,275 @@
+// Генератор позиций для обучения оценочных функций: партии бота против самого себя в нескольких потоках.
+// Каждая партия начинается со случайных полуходов, затем обе стороны ищут ход на небольшую глубину;
+// каждая позиция после дебюта пишется записью position_sample (Models/Sample.h) с оценкой поиска,
+// итогом партии и номером полухода. Файлы читает nnue_trainer (сжатые - через Sample_reader).
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/selfplay.cpp -o selfplay
+// Запуск: selfplay generate <prefix> [--games N] [--threads T] [--depth D] [--random-plies R]
+//                          [--max-turns N] [--shard RECORDS] [--compress 1] [--seed S] [--pdn games.pdn]
+//         selfplay dedup <out.bin> <in.bin>... [--compress 1]
+//         selfplay read <in.bin>...
+// generate пишет prefix.bin (или prefix_000.bin, prefix_001.bin, ... при --shard) и печатает позиций в секунду;
+// dedup оставляет первое вхождение каждой позиции (фигуры и очередь хода); read проверяет файлы и
+// печатает скорость чтения и распределение итогов. С --pdn партии целиком дописываются в PDN-файл
+// (из него Tools/game_db.cpp собирает базу партий).
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "../Engine/Engine.h"
+#include "../Engine/Game_db.h"
+#include "../Models/Sample_stream.h"
+
+struct Generate_options
+{
+    int games = 100;
+    int threads = 0;
+    int depth = 4;
+    int random_plies = 8;
+    int max_turns = 120;
+    size_t shard = 0;
+    bool compress = false;
+    unsigned seed = 1;
+    string pdn; // файл PDN для партий ("" - не писать)
+};
+
+// Оценка бота (отношение сил ходящего) в position_sample::score с точки зрения белых
+static int16_t sample_score(const double score, const bool color)
+{
+    const double limit = 100 * log(double(INF));
+    double cp = is_win(score) ? limit : (is_loss(score) ? -limit : 100 * log(score));
+    cp = min(limit, max(-limit, cp));
+    return int16_t(lround(color ? -cp : cp));
+}
+
+// Одна партия: позиции после дебюта в out, итог проставляется в конце; ходы и итог - в record
+static void play_game(const Generate_options& opt, const unsigned seed, vector<position_sample>& out,
+                      Game_record& record)
+{
+    out.clear();
+    record = Game_record();
+    mt19937 rng(seed);
+    Engine engine;
+    int result = 0;
+    for (int ply = 0;; ++ply)
+    {
+        auto moves = engine.legal_moves();
+        if (moves.empty())
+        {
+            // ходящий проиграл
+            result = engine.side_to_move() ? 1 : -1;
+            break;
+        }
+        if (ply >= opt.max_turns)
+            break;
+        if (ply < opt.random_plies)
+        {
+            const auto& turn = moves[rng() % moves.size()];
+            record.moves.push_back(Engine::move_to_string(turn));
+            engine.play(turn);
+            continue;
+        }
+        Search_limits limits;
+        limits.depth = opt.depth;
+        const auto res = engine.search(limits);
+        position_sample s = position_sample::from_mtx(engine.board(), uint8_t(min(ply, 255)));
+        s.score = sample_score(res.score, engine.side_to_move());
+        out.push_back(s);
+        record.moves.push_back(Engine::move_to_string(res.turn));
+        engine.play(res.turn);
+    }
+    for (auto& s : out)
+        s.result = int8_t(result);
+    record.result = int8_t(result);
+}
+
+static int generate(const string& prefix, const Generate_options& opt)
+{
+    Sample_writer writer;
+    if (!writer.open(prefix, opt.shard, opt.compress))
+    {
+        printf("can't write %s\n", Sample_writer::shard_name(prefix, opt.shard, 0).c_str());
+        return 1;
+    }
+    ofstream pdn;
+    if (!opt.pdn.empty())
+    {
+        pdn.open(opt.pdn, ios::app);
+        if (!pdn)
+        {
+            printf("can't write %s\n", opt.pdn.c_str());
+            return 1;
+        }
+    }
+    const int threads = opt.threads > 0 ? opt.threads : int(max(1u, thread::hardware_concurrency()));
+    atomic<int> next_game{0};
+    atomic<bool> failed{false};
+    mutex write_mutex;
+    int finished = 0;
+    const auto start = chrono::steady_clock::now();
+    auto seconds = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&]() {
+            vector<position_sample> game;
+            Game_record record;
+            for (int g = next_game++; g < opt.games && !failed; g = next_game++)
+            {
+                play_game(opt, opt.seed * 1000003u + unsigned(g), game, record);
+                lock_guard<mutex> lock(write_mutex);
+                if (!writer.write(game.data(), game.size()))
+                    failed = true;
+                if (pdn.is_open() && !(pdn << Game_db::write_pdn(record)))
+                    failed = true;
+                if (++finished % 100 == 0)
+                    printf("%d games, %zu positions, %.0f positions/sec\n", finished, writer.records(),
+                           writer.records() / seconds());
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+    if (!writer.close() || failed)
+    {
+        printf("write error\n");
+        return 1;
+    }
+    const double sec = seconds();
+    printf("games %d, positions %zu, %.1f s, %.0f positions/sec, %.2f bytes/position, %d threads\n", opt.games,
+           writer.records(), sec, writer.records() / max(sec, 1e-9),
+           writer.records() ? double(writer.bytes()) / writer.records() : 0.0, threads);
+    return 0;
+}
+
+// Ключ позиции для удаления повторов: фигуры и очередь хода
+static bool same_position(const position_sample& a, const position_sample& b)
+{
+    return a.white == b.white && a.black == b.black && a.kings == b.kings && a.ply % 2 == b.ply % 2;
+}
+
+static bool position_less(const position_sample& a, const position_sample& b)
+{
+    if (a.white != b.white)
+        return a.white < b.white;
+    if (a.black != b.black)
+        return a.black < b.black;
+    if (a.kings != b.kings)
+        return a.kings < b.kings;
+    return a.ply % 2 < b.ply % 2;
+}
+
+static int dedup(const string& out_path, const vector<string>& inputs, const bool compress)
+{
+    vector<position_sample> data;
+    for (auto& path : inputs)
+    {
+        if (!Sample_reader::load(path, data))
+        {
+            printf("can't read %s\n", path.c_str());
+            return 1;
+        }
+    }
+    const size_t before = data.size();
+    // устойчивая сортировка сохраняет первое вхождение каждой позиции
+    stable_sort(data.begin(), data.end(), position_less);
+    data.erase(unique(data.begin(), data.end(), same_position), data.end());
+    Sample_writer writer;
+    // out_path пишется как есть, без суффикса шарда
+    string prefix = out_path;
+    if (prefix.size() > 4 && prefix.compare(prefix.size() - 4, 4, ".bin") == 0)
+        prefix.resize(prefix.size() - 4);
+    if (!writer.open(prefix, 0, compress) || !writer.write(data.data(), data.size()) || !writer.close())
+    {
+        printf("can't write %s\n", out_path.c_str());
+        return 1;
+    }
+    printf("positions %zu -> %zu (%zu duplicates removed)\n", before, data.size(), before - data.size());
+    return 0;
+}
+
+static int read_files(const vector<string>& inputs)
+{
+    const auto start = chrono::steady_clock::now();
+    vector<position_sample> buf(1 << 16);
+    size_t total = 0, results[3] = {};
+    for (auto& path : inputs)
+    {
+        Sample_reader reader;
+        if (!reader.open(path))
+        {
+            printf("can't read %s\n", path.c_str());
+            return 1;
+        }
+        for (size_t n; (n = reader.read(buf.data(), buf.size())) != 0;)
+        {
+            total += n;
+            for (size_t k = 0; k < n; ++k)
+                ++results[buf[k].result + 1];
+        }
+        if (reader.is_bad())
+        {
+            printf("%s: damaged after %zu positions\n", path.c_str(), total);
+            return 1;
+        }
+    }
+    const double sec = max(chrono::duration<double>(chrono::steady_clock::now() - start).count(), 1e-9);
+    printf("positions %zu (white wins %zu, draws %zu, black wins %zu), %.0f positions/sec\n", total, results[2],
+           results[1], results[0], total / sec);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("usage: selfplay generate <prefix> [--games N] [--threads T] [--depth D] [--random-plies R]\n"
+               "                         [--max-turns N] [--shard RECORDS] [--compress 1] [--seed S] [--pdn games.pdn]\n"
+               "       selfplay dedup <out.bin> <in.bin>... [--compress 1]\n"
+               "       selfplay read <in.bin>...\n");
+        return 1;
+    }
+    const string mode = argv[1];
+    Generate_options opt;
+    vector<string> files;
+    for (int k = 2; k < argc; ++k)
+    {
+        if (!strncmp(argv[k], "--", 2) && k + 1 < argc)
+        {
+            const char* value = argv[++k];
+            if (!strcmp(argv[k - 1], "--games"))
+                opt.games = atoi(value);
+            else if (!strcmp(argv[k - 1], "--threads"))
+                opt.threads = atoi(value);
+            else if (!strcmp(argv[k - 1], "--depth"))
+                opt.depth = atoi(value);
+            else if (!strcmp(argv[k - 1], "--random-plies"))
+                opt.random_plies = atoi(value);
+            else if (!strcmp(argv[k - 1], "--max-turns"))
+                opt.max_turns = atoi(value);
+            else if (!strcmp(argv[k - 1], "--shard"))
+                opt.shard = size_t(atoll(value));
+            else if (!strcmp(argv[k - 1], "--compress"))
+                opt.compress = atoi(value) != 0;
+            else if (!strcmp(argv[k - 1], "--seed"))
+                opt.seed = unsigned(atoll(value));
+            else if (!strcmp(argv[k - 1], "--pdn"))
+                opt.pdn = value;
+        }
+        else
+            files.push_back(argv[k]);
+    }
+    if (mode == "generate" && files.size() == 1)
+        return generate(files[0], opt);
+    if (mode == "dedup" && files.size() >= 2)
+        return dedup(files[0], vector<string>(files.begin() + 1, files.end()), opt.compress);
+    if (mode == "read" && !files.empty())
+        return read_files(files);
+    printf("bad arguments\n");
+    return 1;
+}
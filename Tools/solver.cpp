@@ -0,0 +1,65 @@
+// Решение позиции по числам доказательства: форсированный выигрыш, проигрыш или ничья в пределах лимита полуходов.
+// Правила - как в игре (Logic_rules); для сравнения с обычным перебором печатается ход Engine на глубине --depth.
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/solver.cpp -o solver
+// Запуск: solver <FEN> [--plies N] [--seconds S] [--mb MB] [--depth D]
+#include <cstdio>
+#include <cstring>
+
+#include "../Engine/Solver.h"
+#include "../Engine/Variant_engine.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: solver <fen> [--plies N] [--seconds S] [--mb MB] [--depth D]\n");
+        return 1;
+    }
+    int plies = 120, depth = 0;
+    int64_t seconds = 60;
+    size_t mb = 256;
+    for (int k = 2; k + 1 < argc; k += 2)
+    {
+        if (!strcmp(argv[k], "--plies"))
+            plies = atoi(argv[k + 1]);
+        else if (!strcmp(argv[k], "--seconds"))
+            seconds = atoll(argv[k + 1]);
+        else if (!strcmp(argv[k], "--mb"))
+            mb = size_t(atoll(argv[k + 1]));
+        else if (!strcmp(argv[k], "--depth"))
+            depth = atoi(argv[k + 1]);
+    }
+    Variant_engine<Logic_rules> board;
+    if (!board.set_position(argv[1]))
+    {
+        printf("bad position %s\n", argv[1]);
+        return 1;
+    }
+    Proof_solver<Logic_rules> solver(mb << 20);
+    const auto res = solver.solve(board.current(), plies, 0, seconds * 1000);
+    const char* names[] = {"win", "loss", "draw", "unknown"};
+    printf("result: %s", names[int(res.status)]);
+    if (res.status == Solve_status::Win || res.status == Solve_status::Loss)
+        printf(" in %d plies", res.length);
+    printf(" (limit %d plies, %lld nodes, %lld ms)\n", plies, (long long)res.nodes, (long long)res.time_ms);
+    if (!res.line.empty())
+    {
+        printf("line:");
+        for (auto& m : res.line)
+            printf(" %s", Variant_engine<Logic_rules>::move_to_string(m).c_str());
+        printf("\n");
+    }
+
+    if (depth > 0)
+    {
+        Engine engine;
+        engine.set_position(argv[1]);
+        Search_limits limits;
+        limits.depth = depth;
+        limits.time_ms = seconds * 1000;
+        const auto r = engine.search(limits);
+        printf("alpha-beta depth %d: %s score %g (%lld nodes, %lld ms)\n", r.depth,
+               Engine::move_to_string(r.turn).c_str(), r.score, (long long)r.nodes, (long long)r.time_ms);
+    }
+    return 0;
+}
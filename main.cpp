@@ -2,6 +2,14 @@
 
 int main(int argc, char* argv[])
 {
+    // checkers --replay script.txt - партия по сценарию ввода без окна на экране, с замером задержек
+    if (argc == 3 && string(argv[1]) == "--replay")
+    {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0); // переменная окружения может выбрать другой драйвер
+        Game g;
+        return g.play_script(argv[2]);
+    }
+
     Game g;
     g.play();
 